@@ -2,6 +2,7 @@
 #define API_DOC_H
 
 #include <ArduinoJson.h>
+#include <algorithm>
 #include "APIServer.h"
 
 /**
@@ -23,6 +24,24 @@ public:
         return saveToFile(doc, fs);
     }
 
+    /**
+     * @brief Retourne la documentation OpenAPI sérialisée (générée une fois, en cache)
+     * @param apiServer Instance du serveur API
+     * @return Le JSON OpenAPI, partagé avec le cache (valide tant que la référence est gardée)
+     */
+    static APIServer::DocRendering getOpenAPIDoc(APIServer& apiServer) {
+        return apiServer.getDocRendering(DOC_FORMAT_OPENAPI, [&apiServer](String& output) {
+            JsonDocument doc;
+            JsonObject root = doc.to<JsonObject>();
+            addBaseInfo(apiServer, root);
+            addServerInfo(apiServer, root);
+            addPaths(apiServer, root);
+            serializeJson(doc, output);
+        });
+    }
+
+    static constexpr const char* DOC_FORMAT_OPENAPI = "openapi";
+
 private:
     /**
      * @brief Convertit une chaîne en minuscules
@@ -175,12 +194,12 @@ private:
             
             if (method.type != APIMethodType::EVT) {
                 JsonObject operation = pathItem[httpMethod].to<JsonObject>();
-                operation["description"] = method.description;
+                operation["description"] = method.getDescription();
                 
                 // Add security requirement if basic auth is enabled
                 if (method.auth.enabled) {
                     JsonArray security = operation["security"].to<JsonArray>();
-                    JsonObject requirement = security.createNestedObject();
+                    JsonObject requirement = security.add<JsonObject>();
                     requirement["BasicAuth"] = JsonArray();
                 }
 
@@ -210,9 +229,10 @@ private:
      * @brief Ajoute les paramètres pour les méthodes GET
      */
     static void addGetParameters(const APIMethod& method, JsonObject& operation) {
-        if (!method.requestParams.empty()) {
+        std::vector<APIParam> requestParams = method.getRequestParams();
+        if (!requestParams.empty()) {
             JsonArray parameters = operation["parameters"].to<JsonArray>();
-            for (const auto& param : method.requestParams) {
+            for (const auto& param : requestParams) {
                 JsonObject parameter = parameters.add<JsonObject>();
                 parameter["name"] = param.name;
                 parameter["in"] = "query";
@@ -226,14 +246,16 @@ private:
      * @brief Ajoute le corps de requête pour les méthodes SET
      */
     static void addSetRequestBody(const APIMethod& method, JsonObject& operation) {
-        if (!method.requestParams.empty()) {
+        std::vector<APIParam> requestParams = method.getRequestParams();
+        if (!requestParams.empty()) {
             JsonObject requestBody = operation["requestBody"].to<JsonObject>();
-            requestBody["required"] = true;
+            requestBody["required"] = std::any_of(requestParams.begin(), requestParams.end(),
+                [](const APIParam& param) { return param.required; });
             JsonObject content = requestBody["content"]["application/json"].to<JsonObject>();
             JsonObject schema = content["schema"].to<JsonObject>();
             schema["type"] = "object";
             
-            addProperties(method.requestParams, schema);
+            addProperties(requestParams, schema);
         }
     }
 
@@ -248,7 +270,7 @@ private:
         JsonObject schema = content["schema"].to<JsonObject>();
         schema["type"] = "object";
         
-        addProperties(method.responseParams, schema);
+        addProperties(method.getResponseParams(), schema);
     }
 
     /**
@@ -268,7 +290,7 @@ private:
                     JsonObject subProp = subProps[subParam.name].to<JsonObject>();
                     subProp["type"] = toLowerCase(subParam.type);
                     if (subParam.required) {
-                        if (!prop.containsKey("required")) {
+                        if (!prop["required"].is<JsonArray>()) {
                             prop["required"] = JsonArray();
                         }
                         prop["required"].add(subParam.name);
@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include <vector>
+#include "APIEvent.h"
 
 // Forward declaration
 class APIServer;
@@ -31,8 +32,23 @@ public:
     struct Protocol {
         String name;
         uint8_t capabilities;
+        uint8_t id = NO_PROTOCOL_ID;    // Assigned by APIServer::addEndpoint (bit index in exclusion masks)
     };
 
+    /**
+     * @brief Time spent in poll(), recorded by APIServer::poll when it is given a time budget
+     */
+    struct PollStats {
+        uint32_t polls = 0;             // Budgeted polls
+        uint32_t overruns = 0;          // Polls longer than their slice
+        uint32_t maxDurationUs = 0;     // Longest poll
+        uint32_t maxOverrunUs = 0;      // Worst time spent beyond the slice
+        uint64_t totalDurationUs = 0;   // Sum of the poll durations (average = totalDurationUs / polls)
+    };
+
+    static constexpr uint8_t NO_PROTOCOL_ID = 0xFF;
+    static constexpr uint8_t MAX_PROTOCOLS = 32;    // Width of the method exclusion masks
+
     APIEndpoint(APIServer& apiServer) : _apiServer(apiServer) {}
     virtual ~APIEndpoint() = default;
 
@@ -40,9 +56,53 @@ public:
     virtual void poll() = 0;
     virtual void pushEvent(const String& event, const JsonObject& data) = 0;
 
+    /**
+     * @brief Queue a shared event (called when an event is broadcast)
+     * @brief Endpoints override it to keep a reference instead of copying the payload;
+     * @brief the default forwards to pushEvent().
+     */
+    virtual void queueEvent(const APIEventRef& event) {
+        pushEvent(event->name(), event->data());
+    }
+
+    /**
+     * @brief Check if a client of the endpoint listens to an event (any task)
+     * @brief Endpoints handling subscriptions return false when none of their clients is
+     * @brief interested: the event is then not queued. By default, every event is sent.
+     */
+    virtual bool hasSubscribers(const String& /*event*/) const {
+        return true;
+    }
+
+    /**
+     * @brief Get the depth and wait time of the queued events of a priority class
+     * @brief Endpoints keeping an APIEventQueue return its statistics.
+     */
+    virtual APIQueueStats getEventQueueStats(APIPriority /*priority*/) const {
+        return APIQueueStats();
+    }
+
     const std::vector<Protocol>& getProtocols() const { return _protocols; }
 
+    /**
+     * @brief Set the share of the APIServer::poll budget given to this endpoint (default 1)
+     */
+    void setPollWeight(uint8_t weight) { _pollWeight = weight ? weight : 1; }
+    uint8_t getPollWeight() const { return _pollWeight; }
+
+    // Read from the loop task
+    const PollStats& getPollStats() const { return _pollStats; }
+
 protected:
+    /**
+     * @brief Check if the time slice of the current poll() is spent (never outside a budgeted poll)
+     * @brief Endpoints check it between units of work (chunk, frame, message) and leave the
+     * @brief rest for the next poll(), so that one endpoint cannot hold the loop.
+     */
+    bool pollBudgetExpired() const {
+        return _pollBudgeted && static_cast<long>(micros() - _pollDeadline) >= 0;
+    }
+
     /**
      * @brief Add a protocol to the endpoint
      * @param name Protocol name
@@ -52,8 +112,70 @@ protected:
         _protocols.push_back({name, capabilities});
     }
 
+    /**
+     * @brief Get the ID assigned by the API server to one of the endpoint protocols
+     * @param index Index of the protocol (order of addProtocol calls)
+     * @return Protocol ID, to be passed to APIServer::executeMethod
+     */
+    uint8_t protocolId(size_t index) const {
+        return index < _protocols.size() ? _protocols[index].id : NO_PROTOCOL_ID;
+    }
+
+    /**
+     * @brief Pack the oldest queued events into one frame: {"events":[{...},{...}]}
+     * @brief The JSON encodings of the events are concatenated as is. A single event (or one
+     * @brief that fills the frame alone) is sent unchanged, straight from its shared buffer.
+     * @param queue Events to send, in sending order (taken from an APIEventQueue, not modified)
+     * @param maxSize Maximal size of a packed frame
+     * @param buffer Storage of the packed frame
+     * @param count Receives the number of events in the frame (to pop once sent)
+     * @return The frame to send (event buffer or packed buffer)
+     */
+    template <typename Queue>
+    static const String& packEvents(const Queue& queue, size_t maxSize, String& buffer, size_t& count) {
+        static constexpr size_t PACK_OVERHEAD = 13;     // {"events":[ ... ]}
+        count = 0;
+        buffer = String();
+        if (queue.empty()) {
+            return buffer;
+        }
+        count = 1;
+        const String& first = queue[0]->json();
+        if (queue.size() == 1 || first.length() + queue[1]->json().length() + PACK_OVERHEAD + 1 > maxSize) {
+            return first;
+        }
+        buffer = "{\"events\":[";
+        buffer += first;
+        while (count < queue.size() && buffer.length() + queue[count]->json().length() + 3 <= maxSize) {
+            buffer += ',';
+            buffer += queue[count++]->json();
+        }
+        buffer += "]}";
+        return buffer;
+    }
+
+    /**
+     * @brief Stamp the first count events of a queue as sent (their traces are finished at the first send)
+     */
+    template <typename Queue>
+    static void markEventsSent(const Queue& queue, size_t count) {
+        for (size_t i = 0; i < count && i < queue.size(); i++) {
+            const APITrace& trace = queue[i]->trace();
+            trace.mark(APIStage::Sent);
+            trace.finish();
+        }
+    }
+
     std::vector<Protocol> _protocols;
     APIServer& _apiServer;
+
+private:
+    friend class APIServer;     // Assigns protocol IDs when the endpoint is added, sets the poll slices
+
+    uint8_t _pollWeight = 1;
+    bool _pollBudgeted = false;
+    unsigned long _pollDeadline = 0;    // micros()
+    PollStats _pollStats;
 };
 
 #endif // APIENDPOINT_H 
\ No newline at end of file
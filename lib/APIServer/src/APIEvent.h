@@ -0,0 +1,287 @@
+#ifndef APIEVENT_H
+#define APIEVENT_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "APIPriority.h"
+#include "APITrace.h"
+
+/**
+ * @brief Event broadcast to the endpoints, shared by all of them (immutable once built)
+ * @brief Each wire format is encoded once, by the first endpoint needing it, then every
+ * @brief endpoint and client sends the same buffer: fan-out costs no extra serialization.
+ * @brief Encodings are created by the endpoints when sending (loop task, from APIServer::poll).
+ */
+class APIEvent {
+public:
+    using Encoder = void (*)(const APIEvent& event, String& output);
+
+    static constexpr uint8_t FORMAT_JSON = 0;       // {"event":...,"data":...} (WebSocket, MQTT)
+    static constexpr uint8_t FORMAT_TEXT = 1;       // Line-based text (serial)
+    static constexpr uint8_t FORMAT_SNAPSHOT = 2;   // Full value of a delta event (resync)
+    static constexpr uint8_t MAX_FORMATS = 4;
+
+    APIEvent(const String& name, const JsonObject& data, APIPriority priority = APIPriority::Interactive)
+        : _name(name), _priority(priority) {
+        _data.set(data);
+    }
+
+    /**
+     * @brief Event of a delta-encoded method (APIMethodBuilder::deltaEncoded)
+     * @param seq Sequence number of the event (consecutive for a given event)
+     * @param patch Merge-patch from the previous value, or nullptr to send the full value
+     */
+    APIEvent(const String& name, const JsonObject& data, uint32_t seq, const JsonDocument* patch,
+             APIPriority priority = APIPriority::Interactive)
+        : APIEvent(name, data, priority) {
+        _seq = seq;
+        if (patch) {
+            _patch.set(*patch);
+            _isPatch = true;
+        }
+    }
+
+    APIEvent(const APIEvent&) = delete;
+    APIEvent& operator=(const APIEvent&) = delete;
+
+    const String& name() const { return _name; }
+
+    // Priority class of the event method (order of sending in the endpoint queues)
+    APIPriority priority() const { return _priority; }
+
+    // Payload of the event (do not modify: shared by all endpoints)
+    JsonObject data() const { return _data.as<JsonObject>(); }
+
+    // Delta events: sequence number (0 otherwise), and changes since the previous event
+    uint32_t seq() const { return _seq; }
+    bool isPatch() const { return _isPatch; }
+    JsonObject patch() const { return _patch.as<JsonObject>(); }
+
+    // Trace of the event (empty if tracing is off): endpoints stamp Queued and Sent, then finish it
+    const APITrace& trace() const { return _trace; }
+
+    // Attach the trace (by the APIServer, before the event is shared)
+    void setTrace(const APITrace& trace) { _trace = trace; }
+
+    /**
+     * @brief Get the event encoded in a wire format (encoded on first use)
+     * @param format Format slot (FORMAT_JSON, FORMAT_TEXT or an endpoint-defined one < MAX_FORMATS)
+     * @param encode Function encoding the event in this format
+     */
+    const String& encoded(uint8_t format, Encoder encode) const {
+        Encoding& slot = _encodings[format < MAX_FORMATS ? format : MAX_FORMATS - 1];
+        if (!slot.ready) {
+            encode(*this, slot.output);
+            slot.ready = true;
+            _trace.mark(APIStage::Serialized);
+        }
+        return slot.output;
+    }
+
+    /**
+     * @brief Get the event encoded as {"event":...,"data":...}
+     * @brief Delta events: {"event":...,"seq":n,"patch":...}, or "data" when sent in full.
+     */
+    const String& json() const {
+        return encoded(FORMAT_JSON, [](const APIEvent& event, String& output) {
+            encodeJson(event, event.isPatch(), output);
+        });
+    }
+
+    /**
+     * @brief Get the full value of the event, {"event":...,"seq":n,"data":...}
+     * @brief Sent to the clients resynchronizing after a sequence gap.
+     */
+    const String& snapshot() const {
+        if (!_isPatch) {
+            return json();
+        }
+        return encoded(FORMAT_SNAPSHOT, [](const APIEvent& event, String& output) {
+            encodeJson(event, false, output);
+        });
+    }
+
+private:
+    struct Encoding {
+        String output;
+        bool ready = false;
+    };
+
+    String _name;
+    APIPriority _priority;
+    mutable JsonDocument _data;                     // Mutable only because JsonDocument::as<JsonObject>() is not const
+    mutable JsonDocument _patch;
+    uint32_t _seq = 0;
+    bool _isPatch = false;
+    mutable Encoding _encodings[MAX_FORMATS];
+    APITrace _trace;
+
+    static void encodeJson(const APIEvent& event, bool patch, String& output) {
+        JsonDocument doc;
+        doc["event"] = event.name();
+        if (event.seq()) {
+            doc["seq"] = event.seq();
+        }
+        if (patch) {
+            doc["patch"] = event.patch();
+        } else {
+            doc["data"] = event.data();
+        }
+        serializeJson(doc, output);
+    }
+};
+
+using APIEventRef = std::shared_ptr<const APIEvent>;
+
+/**
+ * @brief Fixed-capacity queue of shared events (endpoint outgoing queue)
+ * @brief Holds references only: queueing an event copies no payload and allocates nothing.
+ * @brief One ring per priority class, read in weighted round-robin order (same weights as the
+ * @brief request mailboxes, see APIPriorityMailbox): control events are sent first without
+ * @brief starving telemetry, and a flood of telemetry only drops telemetry. Events of a class
+ * @brief keep their order. When a class is full, its oldest event is dropped.
+ * @brief Events are pushed by the task broadcasting them (any task) and taken by the endpoint
+ * @brief from the loop task: both go through a short lock, the taken events are then sent
+ * @brief without it.
+ */
+template <size_t Capacity>
+class APIEventQueue {
+public:
+    /**
+     * @brief Add an event, dropping the oldest one of its class if the class is full
+     * @return False if an event was dropped
+     */
+    bool push(const APIEventRef& event) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Ring& ring = _classes[classIndex(event->priority())];
+        bool dropped = false;
+        if (ring.count == Capacity) {
+            ring.entries[ring.head] = Entry();
+            ring.head = (ring.head + 1) % Capacity;
+            ring.count--;
+            ring.stats.rejected++;
+            dropped = true;
+        } else {
+            _count++;
+        }
+        Entry& entry = ring.entries[(ring.head + ring.count) % Capacity];
+        entry.event = event;
+        entry.queuedAt = micros();
+        ring.count++;
+        if (ring.count > ring.stats.maxDepth) {
+            ring.stats.maxDepth = ring.count;
+        }
+        return !dropped;
+    }
+
+    /**
+     * @brief Take the next events, in sending order
+     * @param events Receives the events (appended)
+     * @param maxCount Maximal number of events taken
+     * @return Number of events taken
+     */
+    size_t take(std::vector<APIEventRef>& events, size_t maxCount = Capacity * API_PRIORITY_COUNT) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        size_t taken = 0;
+        for (; taken < maxCount && _count > 0; taken++) {
+            events.push_back(takeNext());
+        }
+        return taken;
+    }
+
+    /**
+     * @brief Take the next event to send (nullptr if the queue is empty)
+     */
+    APIEventRef take() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _count > 0 ? takeNext() : APIEventRef();
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _count;
+    }
+
+    bool empty() const { return size() == 0; }
+    static constexpr size_t capacity() { return Capacity; }
+
+    /**
+     * @brief Queue depth and wait time of the events of a priority class (wait = push -> take)
+     */
+    APIQueueStats getStats(APIPriority priority) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const Ring& ring = _classes[classIndex(priority)];
+        APIQueueStats stats = ring.stats;
+        stats.depth = ring.count;
+        return stats;
+    }
+
+private:
+    struct Entry {
+        APIEventRef event;
+        unsigned long queuedAt = 0;     // micros()
+    };
+
+    struct Ring {
+        Entry entries[Capacity];
+        size_t head = 0;
+        size_t count = 0;
+        APIQueueStats stats;
+    };
+
+    // Weighted round-robin position: class being served and events left for it in this round
+    struct Cursor {
+        size_t current = 0;
+        uint8_t credit = API_PRIORITY_WEIGHTS[0];
+    };
+
+    Ring _classes[API_PRIORITY_COUNT];
+    size_t _count = 0;
+    Cursor _cursor;
+    mutable std::mutex _mutex;
+
+    /**
+     * @brief Remove the next event in the sending order (lock held, queue not empty)
+     */
+    APIEventRef takeNext() {
+        Ring& ring = _classes[nextClass()];
+        Entry& entry = ring.entries[ring.head];
+        uint32_t wait = static_cast<uint32_t>(micros() - entry.queuedAt);
+        ring.stats.served++;
+        ring.stats.totalWaitUs += wait;
+        if (wait > ring.stats.maxWaitUs) {
+            ring.stats.maxWaitUs = wait;
+        }
+        APIEventRef event = std::move(entry.event);
+        entry = Entry();
+        ring.head = (ring.head + 1) % Capacity;
+        ring.count--;
+        _count--;
+        return event;
+    }
+
+    /**
+     * @brief Advance the cursor to the class of the next event (queue not empty)
+     */
+    size_t nextClass() {
+        for (size_t i = 0; i <= API_PRIORITY_COUNT; i++) {
+            if (_cursor.credit > 0 && _classes[_cursor.current].count > 0) {
+                _cursor.credit--;
+                return _cursor.current;
+            }
+            _cursor.current = (_cursor.current + 1) % API_PRIORITY_COUNT;
+            _cursor.credit = API_PRIORITY_WEIGHTS[_cursor.current];
+        }
+        return _cursor.current;
+    }
+
+    static size_t classIndex(APIPriority priority) {
+        size_t index = static_cast<size_t>(priority);
+        return index < API_PRIORITY_COUNT ? index : static_cast<size_t>(APIPriority::Interactive);
+    }
+};
+
+#endif // APIEVENT_H
@@ -0,0 +1,111 @@
+#ifndef APIMAILBOX_H
+#define APIMAILBOX_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+/**
+ * @brief Bounded lock-free mailbox (multiple producers, multiple consumers)
+ * @brief Fixed ring of Capacity cells allocated once; each cell carries a sequence number
+ * @brief telling producers and consumers whether it is free or filled. Posting or taking
+ * @brief a message is one compare-and-swap on the position plus one store on the cell:
+ * @brief no lock, no allocation, usable between the AsyncTCP task, the loop task and a worker.
+ * @brief Capacity must be a power of two.
+ */
+template <typename T, size_t Capacity>
+class APIMailbox {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "APIMailbox capacity must be a power of two");
+
+public:
+    APIMailbox() {
+        for (size_t i = 0; i < Capacity; i++) {
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    APIMailbox(const APIMailbox&) = delete;
+    APIMailbox& operator=(const APIMailbox&) = delete;
+
+    /**
+     * @brief Post a message
+     * @param value Message, moved into the mailbox only on success (can be posted again otherwise)
+     * @return False if the mailbox is full
+     */
+    bool push(T&& value) {
+        Cell* cell;
+        size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &_cells[pos & MASK];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;   // Full
+            } else {
+                pos = _enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Take the oldest message
+     * @param value Receives the message
+     * @return False if the mailbox is empty
+     */
+    bool pop(T& value) {
+        Cell* cell;
+        size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &_cells[pos & MASK];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;   // Empty
+            } else {
+                pos = _dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(cell->data);
+        cell->data = T();       // Release what the message owned (strings, documents) now
+        cell->sequence.store(pos + MASK + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Number of messages waiting (approximate while producers/consumers are active)
+     */
+    size_t size() const {
+        size_t enqueued = _enqueuePos.load(std::memory_order_acquire);
+        size_t dequeued = _dequeuePos.load(std::memory_order_acquire);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    bool empty() const { return size() == 0; }
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    Cell _cells[Capacity];
+    alignas(64) std::atomic<size_t> _enqueuePos{0};     // Separate cache lines: producers and consumers
+    alignas(64) std::atomic<size_t> _dequeuePos{0};     // do not invalidate each other
+};
+
+#endif // APIMAILBOX_H
@@ -0,0 +1,62 @@
+#ifndef APIMERGEPATCH_H
+#define APIMERGEPATCH_H
+
+#include <ArduinoJson.h>
+
+/**
+ * @brief JSON merge-patch (RFC 7386) between two values of an event
+ * @brief Changed or added members are copied, removed members are set to null, nested objects
+ * @brief are compared recursively and arrays are replaced as a whole. Applying the patch to
+ * @brief the previous value gives the new one (as long as the values hold no null member).
+ */
+class APIMergePatch {
+public:
+    /**
+     * @brief Build the patch turning a value into another
+     * @param from Previous value
+     * @param to New value
+     * @param patch Receives the changes (empty if the values are equal)
+     */
+    static void diff(JsonObjectConst from, JsonObjectConst to, JsonObject patch) {
+        for (JsonPairConst member : to) {
+            JsonVariantConst previous = from[member.key()];
+            JsonVariantConst current = member.value();
+            if (previous.is<JsonObjectConst>() && current.is<JsonObjectConst>()) {
+                JsonObject nested = patch[member.key()].to<JsonObject>();
+                diff(previous.as<JsonObjectConst>(), current.as<JsonObjectConst>(), nested);
+                if (nested.size() == 0) {
+                    patch.remove(member.key());
+                }
+            } else if (previous.isNull() || previous != current) {
+                patch[member.key()] = current;
+            }
+        }
+        for (JsonPairConst member : from) {
+            if (to[member.key()].isNull()) {     // Absent (a null member is absent too)
+                patch[member.key()] = nullptr;
+            }
+        }
+    }
+
+    /**
+     * @brief Apply a patch to a value
+     * @param target Value to update
+     * @param patch Patch built by diff()
+     */
+    static void apply(JsonObject target, JsonObjectConst patch) {
+        for (JsonPairConst member : patch) {
+            JsonVariantConst change = member.value();
+            if (change.isNull()) {
+                target.remove(member.key());
+            } else if (change.is<JsonObjectConst>()) {
+                JsonObject nested = target[member.key()].is<JsonObject>() ? target[member.key()].as<JsonObject>()
+                                                                           : target[member.key()].to<JsonObject>();
+                apply(nested, change.as<JsonObjectConst>());
+            } else {
+                target[member.key()] = change;
+            }
+        }
+    }
+};
+
+#endif // APIMERGEPATCH_H
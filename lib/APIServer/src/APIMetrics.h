@@ -0,0 +1,235 @@
+#ifndef APIMETRICS_H
+#define APIMETRICS_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <atomic>
+#include <vector>
+
+/**
+ * @brief Phase of a method call measured by the metrics
+ */
+enum class APIPhase : uint8_t {
+    Validate = 0,       // Arguments checked against the compiled schema
+    Handler = 1,        // Handler or writer (deferred: start -> completion)
+    Serialize = 2       // Response serialized, or loaded in the caller's document
+};
+
+static constexpr size_t API_PHASE_COUNT = 3;
+
+constexpr const char* apiPhaseToString(APIPhase phase) {
+    switch (phase) {
+        case APIPhase::Validate: return "validate";
+        case APIPhase::Handler: return "handler";
+        case APIPhase::Serialize: return "serialize";
+        default: return "unknown";
+    }
+}
+
+/**
+ * @brief Latency histogram with fixed buckets (µs)
+ * @brief Recording is a few relaxed atomic operations (any task, no lock, no allocation).
+ * @brief All counters are 32-bit, lock-free on Xtensa (a 64-bit atomic takes a lock there):
+ * @brief the total wraps after ~71 min of cumulative time, scrapers use the delta modulo 2^32.
+ */
+class APILatencyHistogram {
+public:
+    static constexpr size_t BUCKET_COUNT = 10;
+    // Upper bound of each bucket (µs), the last bucket holds the slower samples
+    static constexpr uint32_t BOUNDS_US[BUCKET_COUNT - 1] = {50, 100, 250, 500, 1000, 2500, 5000, 10000, 50000};
+
+    void record(uint32_t us) {
+        size_t bucket = 0;
+        while (bucket < BUCKET_COUNT - 1 && us > BOUNDS_US[bucket]) {
+            bucket++;
+        }
+        _buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        _count.fetch_add(1, std::memory_order_relaxed);
+        _totalUs.fetch_add(us, std::memory_order_relaxed);
+        // Raised from several tasks: a larger sample stored meanwhile is kept
+        uint32_t max = _maxUs.load(std::memory_order_relaxed);
+        while (us > max && !_maxUs.compare_exchange_weak(max, us, std::memory_order_relaxed)) {
+        }
+    }
+
+    uint32_t count() const { return _count.load(std::memory_order_relaxed); }
+    uint32_t totalUs() const { return _totalUs.load(std::memory_order_relaxed); }
+    uint32_t maxUs() const { return _maxUs.load(std::memory_order_relaxed); }
+    uint32_t bucket(size_t index) const { return _buckets[index].load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint32_t> _buckets[BUCKET_COUNT] = {};
+    std::atomic<uint32_t> _count{0};
+    std::atomic<uint32_t> _totalUs{0};                  // Wraps (see above)
+    std::atomic<uint32_t> _maxUs{0};
+};
+
+/**
+ * @brief Counters and phase latencies of a registered method
+ * @brief Shared by the copies of the method in the registry snapshots (see APIMethod::metrics),
+ * @brief updated from any task by APIServer::executeMethod and the deferred/worker paths.
+ */
+class APIMethodMetrics {
+public:
+    static constexpr size_t PROTOCOL_SLOTS = 8;    // Protocol IDs counted separately, the others share the last slot
+
+    void recordCall(uint8_t protocolId, bool success) {
+        ProtocolCounters& counters = _protocols[slot(protocolId)];
+        counters.calls.fetch_add(1, std::memory_order_relaxed);
+        if (!success) {
+            counters.errors.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void recordPhase(APIPhase phase, uint32_t us) {
+        _phases[static_cast<size_t>(phase)].record(us);
+    }
+
+    void recordCacheHit() {
+        _cacheHits.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Protocol ID (or PROTOCOL_SLOTS for the other protocols and internal calls)
+    uint32_t calls(size_t protocolSlot) const { return _protocols[protocolSlot].calls.load(std::memory_order_relaxed); }
+    uint32_t errors(size_t protocolSlot) const { return _protocols[protocolSlot].errors.load(std::memory_order_relaxed); }
+
+    uint32_t calls() const {
+        uint32_t total = 0;
+        for (size_t i = 0; i <= PROTOCOL_SLOTS; i++) {
+            total += calls(i);
+        }
+        return total;
+    }
+
+    uint32_t errors() const {
+        uint32_t total = 0;
+        for (size_t i = 0; i <= PROTOCOL_SLOTS; i++) {
+            total += errors(i);
+        }
+        return total;
+    }
+
+    uint32_t cacheHits() const { return _cacheHits.load(std::memory_order_relaxed); }
+
+    const APILatencyHistogram& phase(APIPhase phase) const { return _phases[static_cast<size_t>(phase)]; }
+
+    static size_t slot(uint8_t protocolId) {
+        return protocolId < PROTOCOL_SLOTS ? protocolId : PROTOCOL_SLOTS;
+    }
+
+private:
+    struct ProtocolCounters {
+        std::atomic<uint32_t> calls{0};
+        std::atomic<uint32_t> errors{0};
+    };
+
+    ProtocolCounters _protocols[PROTOCOL_SLOTS + 1];
+    std::atomic<uint32_t> _cacheHits{0};
+    APILatencyHistogram _phases[API_PHASE_COUNT];
+};
+
+/**
+ * @brief Compact binary encoding of the metrics (scraped from many devices)
+ * @brief Unsigned LEB128 varints: small counters take one byte. Layout (version 1):
+ * @brief   'A' 'M' version
+ * @brief   uptime (ms) unknownCalls bucketCount bound[bucketCount - 1]
+ * @brief   protocolCount {nameLength name}[protocolCount]
+ * @brief   methodCount then for each method:
+ * @brief     pathLength path cacheHits {calls errors}[protocolCount + 1]
+ * @brief     {count totalUs maxUs bucket[bucketCount]}[validate, handler, serialize]
+ * @brief The last {calls errors} pair counts the other protocols and internal calls. All values
+ * @brief are 32-bit counters (totalUs wraps, see APILatencyHistogram).
+ */
+class APIMetricsEncoder {
+public:
+    static constexpr uint8_t VERSION = 1;
+
+    explicit APIMetricsEncoder(std::vector<uint8_t>& output) : _output(output) {}
+
+    void header(uint32_t uptime, uint32_t unknownCalls) {
+        _output.push_back('A');
+        _output.push_back('M');
+        _output.push_back(VERSION);
+        varint(uptime);
+        varint(unknownCalls);
+        varint(APILatencyHistogram::BUCKET_COUNT);
+        for (uint32_t bound : APILatencyHistogram::BOUNDS_US) {
+            varint(bound);
+        }
+    }
+
+    void protocols(const std::vector<String>& names, size_t count) {
+        varint(count);
+        for (size_t i = 0; i < count; i++) {
+            text(names[i]);
+        }
+    }
+
+    void methodCount(size_t count) {
+        varint(count);
+    }
+
+    void method(const String& path, const APIMethodMetrics& metrics, size_t protocolCount) {
+        text(path);
+        varint(metrics.cacheHits());
+        for (size_t i = 0; i < protocolCount; i++) {
+            varint(metrics.calls(i));
+            varint(metrics.errors(i));
+        }
+        // Other protocols and internal calls
+        uint32_t calls = 0;
+        uint32_t errors = 0;
+        for (size_t i = protocolCount; i <= APIMethodMetrics::PROTOCOL_SLOTS; i++) {
+            calls += metrics.calls(i);
+            errors += metrics.errors(i);
+        }
+        varint(calls);
+        varint(errors);
+        for (size_t p = 0; p < API_PHASE_COUNT; p++) {
+            const APILatencyHistogram& histogram = metrics.phase(static_cast<APIPhase>(p));
+            varint(histogram.count());
+            varint(histogram.totalUs());
+            varint(histogram.maxUs());
+            for (size_t b = 0; b < APILatencyHistogram::BUCKET_COUNT; b++) {
+                varint(histogram.bucket(b));
+            }
+        }
+    }
+
+    /**
+     * @brief Base64 text of a binary buffer (binary metrics carried by the JSON transports)
+     */
+    static String base64(const std::vector<uint8_t>& data) {
+        static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        String text;
+        text.reserve(((data.size() + 2) / 3) * 4);
+        for (size_t i = 0; i < data.size(); i += 3) {
+            uint32_t chunk = static_cast<uint32_t>(data[i]) << 16;
+            if (i + 1 < data.size()) chunk |= static_cast<uint32_t>(data[i + 1]) << 8;
+            if (i + 2 < data.size()) chunk |= data[i + 2];
+            text += ALPHABET[(chunk >> 18) & 0x3F];
+            text += ALPHABET[(chunk >> 12) & 0x3F];
+            text += i + 1 < data.size() ? ALPHABET[(chunk >> 6) & 0x3F] : '=';
+            text += i + 2 < data.size() ? ALPHABET[chunk & 0x3F] : '=';
+        }
+        return text;
+    }
+
+private:
+    std::vector<uint8_t>& _output;
+
+    void varint(uint64_t value) {
+        while (value >= 0x80) {
+            _output.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        _output.push_back(static_cast<uint8_t>(value));
+    }
+
+    void text(const String& value) {
+        varint(value.length());
+        _output.insert(_output.end(), value.c_str(), value.c_str() + value.length());
+    }
+};
+
+#endif // APIMETRICS_H
@@ -0,0 +1,61 @@
+#ifndef APIPENDINGRESPONSE_H
+#define APIPENDINGRESPONSE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <atomic>
+#include <memory>
+
+/**
+ * @brief Token of a deferred method response
+ * @brief Returned by a deferred handler, which keeps a copy and completes it later (typically
+ * @brief from the module poll()). The APIServer delivers the response to the endpoint from
+ * @brief APIServer::poll(), so slow operations never block the transport task.
+ * @brief Copies share the same state (the token is a handle).
+ */
+class APIPendingResponse {
+public:
+    APIPendingResponse() : _state(std::make_shared<State>()) {}
+
+    /**
+     * @brief Response object to fill before complete()
+     */
+    JsonObject response() {
+        if (!_state->doc.is<JsonObject>()) {
+            return _state->doc.to<JsonObject>();
+        }
+        return _state->doc.as<JsonObject>();
+    }
+
+    /**
+     * @brief Complete the response (can be called from another task)
+     * @param success False if the operation failed (the client gets an error)
+     */
+    void complete(bool success = true) {
+        _state->success = success;
+        _state->done.store(true);
+    }
+
+    /**
+     * @brief Cancel the request (client gone, or timeout): the response will not be delivered
+     */
+    void cancel() {
+        _state->cancelled.store(true);
+    }
+
+    bool isDone() const { return _state->done.load(); }
+    bool isCancelled() const { return _state->cancelled.load(); }
+    bool succeeded() const { return _state->success; }
+
+private:
+    struct State {
+        JsonDocument doc;
+        bool success = false;
+        std::atomic<bool> done{false};
+        std::atomic<bool> cancelled{false};
+    };
+
+    std::shared_ptr<State> _state;
+};
+
+#endif // APIPENDINGRESPONSE_H
@@ -0,0 +1,49 @@
+#ifndef APIPRIORITY_H
+#define APIPRIORITY_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Priority class of a method: its queued requests and events are scheduled accordingly
+ */
+enum class APIPriority : uint8_t {
+    Control = 0,        // Commands that must not wait behind the others (configuration, actuators)
+    Interactive = 1,    // Requests of a user or dashboard (default)
+    Telemetry = 2       // Periodic reads and events, fine with some delay
+};
+
+static constexpr size_t API_PRIORITY_COUNT = 3;
+static constexpr uint8_t API_PRIORITY_WEIGHTS[API_PRIORITY_COUNT] = {4, 2, 1};  // Messages served per round, by class
+
+constexpr const char* apiPriorityToString(APIPriority priority) {
+    switch (priority) {
+        case APIPriority::Control: return "control";
+        case APIPriority::Interactive: return "interactive";
+        case APIPriority::Telemetry: return "telemetry";
+        default: return "unknown";
+    }
+}
+
+/**
+ * @brief Queue statistics of a priority class
+ */
+struct APIQueueStats {
+    uint32_t depth = 0;             // Messages waiting
+    uint32_t maxDepth = 0;          // Highest depth seen
+    uint32_t served = 0;            // Messages taken by the consumer
+    uint32_t rejected = 0;          // Messages refused or dropped (class full)
+    uint32_t maxWaitUs = 0;         // Worst post -> take delay
+    uint64_t totalWaitUs = 0;       // Sum of the delays (average = totalWaitUs / served)
+
+    APIQueueStats& operator+=(const APIQueueStats& other) {
+        depth += other.depth;
+        maxDepth += other.maxDepth;
+        served += other.served;
+        rejected += other.rejected;
+        maxWaitUs = other.maxWaitUs > maxWaitUs ? other.maxWaitUs : maxWaitUs;
+        totalWaitUs += other.totalWaitUs;
+        return *this;
+    }
+};
+
+#endif // APIPRIORITY_H
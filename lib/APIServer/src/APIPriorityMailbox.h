@@ -0,0 +1,124 @@
+#ifndef APIPRIORITYMAILBOX_H
+#define APIPRIORITYMAILBOX_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "APIMailbox.h"
+#include "APIPriority.h"
+
+/**
+ * @brief One bounded mailbox per priority class, served with weighted fairness
+ * @brief Producers post from any task (lock-free, see APIMailbox); each class has its own
+ * @brief capacity, so a burst of telemetry cannot fill the room of control requests. The
+ * @brief consumer (single task) takes up to API_PRIORITY_WEIGHTS[class] messages from a class
+ * @brief before moving to the next non-empty one (weighted round robin): a control request
+ * @brief waits behind at most 3 messages of the other classes, and no class starves.
+ * @tparam T Message type
+ * @tparam Capacity Capacity of each class (power of two)
+ */
+template <typename T, size_t Capacity>
+class APIPriorityMailbox {
+public:
+    /**
+     * @brief Post a message (any task, never blocks)
+     * @param value Message, moved into the mailbox only on success
+     * @param priority Class of the message
+     * @return False if the mailbox of the class is full
+     */
+    bool push(T&& value, APIPriority priority) {
+        size_t index = classIndex(priority);
+        Entry entry;
+        entry.value = std::move(value);
+        entry.postedAt = micros();
+        ClassQueue& queue = _classes[index];
+        if (!queue.mailbox.push(std::move(entry))) {
+            value = std::move(entry.value);     // Left to the caller, as with APIMailbox
+            queue.rejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        uint32_t depth = queue.mailbox.size();
+        if (depth > queue.maxDepth.load(std::memory_order_relaxed)) {
+            queue.maxDepth.store(depth, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Take the next message in weighted order (single consumer task)
+     * @param value Receives the message
+     * @return False if every class is empty
+     */
+    bool pop(T& value) {
+        for (size_t i = 0; i <= API_PRIORITY_COUNT; i++) {
+            if (_credit > 0) {
+                Entry entry;
+                ClassQueue& queue = _classes[_current];
+                if (queue.mailbox.pop(entry)) {
+                    _credit--;
+                    uint32_t wait = static_cast<uint32_t>(micros() - entry.postedAt);
+                    queue.served.fetch_add(1, std::memory_order_relaxed);
+                    queue.totalWaitUs.fetch_add(wait, std::memory_order_relaxed);
+                    if (wait > queue.maxWaitUs.load(std::memory_order_relaxed)) {
+                        queue.maxWaitUs.store(wait, std::memory_order_relaxed);
+                    }
+                    value = std::move(entry.value);
+                    return true;
+                }
+            }
+            _current = (_current + 1) % API_PRIORITY_COUNT;
+            _credit = API_PRIORITY_WEIGHTS[_current];
+        }
+        return false;
+    }
+
+    /**
+     * @brief Number of messages waiting in all classes (approximate while in use)
+     */
+    size_t size() const {
+        size_t total = 0;
+        for (const auto& queue : _classes) {
+            total += queue.mailbox.size();
+        }
+        return total;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    APIQueueStats getStats(APIPriority priority) const {
+        const ClassQueue& queue = _classes[classIndex(priority)];
+        APIQueueStats stats;
+        stats.depth = queue.mailbox.size();
+        stats.maxDepth = queue.maxDepth.load(std::memory_order_relaxed);
+        stats.served = queue.served.load(std::memory_order_relaxed);
+        stats.rejected = queue.rejected.load(std::memory_order_relaxed);
+        stats.maxWaitUs = queue.maxWaitUs.load(std::memory_order_relaxed);
+        stats.totalWaitUs = queue.totalWaitUs.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    struct Entry {
+        T value;
+        unsigned long postedAt = 0;     // micros()
+    };
+
+    struct ClassQueue {
+        APIMailbox<Entry, Capacity> mailbox;
+        std::atomic<uint32_t> maxDepth{0};
+        std::atomic<uint32_t> served{0};
+        std::atomic<uint32_t> rejected{0};
+        std::atomic<uint32_t> maxWaitUs{0};
+        std::atomic<uint64_t> totalWaitUs{0};
+    };
+
+    ClassQueue _classes[API_PRIORITY_COUNT];
+    size_t _current = 0;                        // Class being served (consumer only)
+    uint8_t _credit = API_PRIORITY_WEIGHTS[0];               // Messages left for it in this round
+
+    static size_t classIndex(APIPriority priority) {
+        size_t index = static_cast<size_t>(priority);
+        return index < API_PRIORITY_COUNT ? index : static_cast<size_t>(APIPriority::Interactive);
+    }
+};
+
+#endif // APIPRIORITYMAILBOX_H
@@ -0,0 +1,166 @@
+#ifndef APIRESPONSECACHE_H
+#define APIRESPONSECACHE_H
+
+#include <Arduino.h>
+#include <map>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Cache of serialized GET responses, declared per method (APIMethodBuilder::cache)
+ * @brief A cached response is served as is until its TTL expires or one of its invalidation
+ * @brief keys is bumped (invalidate): by a SET declaring it (APIMethodBuilder::invalidates),
+ * @brief or by a module whose state changed. The path of a method is always one of its keys.
+ * @brief Only calls without arguments are cached. Accessed from any task (short lock, the
+ * @brief handlers always run outside of it).
+ */
+class APIResponseCache {
+public:
+    struct Stats {
+        uint32_t hits = 0;              // Responses served from the cache
+        uint32_t misses = 0;            // Handler called (empty, expired or invalidated entry)
+        uint32_t invalidations = 0;     // Entries dropped by a key
+    };
+
+    /**
+     * @brief Declare the cache policy of a method (called at registration)
+     * @param path The path of the method
+     * @param enabled False to remove the method from the cache
+     * @param keys Invalidation keys, besides the path
+     */
+    void configure(const String& path, bool enabled, const std::vector<String>& keys) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!enabled) {
+            _entries.erase(path);
+            return;
+        }
+        Entry& entry = _entries[path];
+        entry.keys = keys;
+        entry.valid = false;
+        entry.body = String();
+    }
+
+    /**
+     * @brief Get a cached response
+     * @param path The path of the method
+     * @param ttl Lifetime of the response (ms, 0 = until invalidated)
+     * @param output Receives the response on hit (appended)
+     * @param generation Receives the token to give to put() on miss
+     * @return True on hit
+     */
+    bool get(const String& path, uint32_t ttl, String& output, uint32_t& generation) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        generation = _generation;
+        return lookup(path, ttl, output, true);
+    }
+
+    /**
+     * @brief Get a cached response, without counting a miss (caller falls back to get())
+     * @return True on hit
+     */
+    bool peek(const String& path, uint32_t ttl, String& output) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return lookup(path, ttl, output, false);
+    }
+
+    /**
+     * @brief Store a response computed after a miss
+     * @brief Dropped if a key was invalidated since get(): the handler may have read the old state.
+     * @param generation Token returned by get()
+     */
+    void put(const String& path, const String& body, uint32_t generation) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _entries.find(path);
+        if (it == _entries.end() || generation != _generation) {
+            return;
+        }
+        it->second.body = body;
+        it->second.storedAt = millis();
+        it->second.valid = true;
+    }
+
+    /**
+     * @brief Drop the responses depending on a key
+     * @param key A method path or an invalidation key
+     */
+    void invalidate(const String& key) {
+        invalidate(key.c_str());
+    }
+
+    // Key from a flash descriptor: compared in place, no String built
+    void invalidate(const char* key) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _generation++;
+        for (auto& [path, entry] : _entries) {
+            if (!entry.valid || (path != key && !dependsOn(entry, key))) {
+                continue;
+            }
+            entry.valid = false;
+            entry.body = String();
+            entry.stats.invalidations++;
+        }
+    }
+
+    /**
+     * @brief Get the counters of a method, or of all methods
+     * @param path The path of the method (empty = sum of all cached methods)
+     */
+    Stats getStats(const String& path = "") const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Stats total;
+        for (const auto& [entryPath, entry] : _entries) {
+            if (!path.isEmpty() && entryPath != path) {
+                continue;
+            }
+            total.hits += entry.stats.hits;
+            total.misses += entry.stats.misses;
+            total.invalidations += entry.stats.invalidations;
+        }
+        return total;
+    }
+
+private:
+    struct Entry {
+        String body;
+        unsigned long storedAt = 0;
+        bool valid = false;
+        std::vector<String> keys;
+        Stats stats;
+    };
+
+    std::map<String, Entry> _entries;       // Cached methods, by path
+    uint32_t _generation = 0;               // Incremented at each invalidation
+    mutable std::mutex _mutex;
+
+    bool lookup(const String& path, uint32_t ttl, String& output, bool countMiss) {
+        auto it = _entries.find(path);
+        if (it == _entries.end()) {
+            return false;
+        }
+        Entry& entry = it->second;
+        if (entry.valid && ttl && millis() - entry.storedAt >= ttl) {
+            entry.valid = false;        // Expired
+            entry.body = String();
+        }
+        if (!entry.valid) {
+            if (countMiss) {
+                entry.stats.misses++;
+            }
+            return false;
+        }
+        entry.stats.hits++;
+        output += entry.body;
+        return true;
+    }
+
+    static bool dependsOn(const Entry& entry, const char* key) {
+        for (const auto& k : entry.keys) {
+            if (k == key) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+#endif // APIRESPONSECACHE_H
@@ -0,0 +1,277 @@
+#ifndef APIRESPONSEWRITER_H
+#define APIRESPONSEWRITER_H
+
+#include <Arduino.h>
+#include <vector>
+#include <cmath>
+#include <type_traits>
+
+/**
+ * @brief Response layout, compiled from the responseParams of a method
+ * @brief Each declared field becomes a step (depth-first order) holding its key already
+ * @brief rendered as JSON ("key":), its type and the size of its nested properties.
+ * @brief A layout is complete only if every object declares its properties.
+ */
+class APIResponseLayout {
+public:
+    enum class Check : uint8_t {
+        Boolean,
+        Integer,
+        Number,
+        String,
+        Object
+    };
+
+    struct Field {
+        String name;
+        String prefix;              // Rendered key: "name":
+        Check check;
+        uint8_t depth;              // 0 = response root
+        bool required;
+        uint16_t subtreeSize;       // Number of steps of nested properties following this one
+    };
+
+    /**
+     * @brief Compile the layout from response parameters
+     * @param params Response schema (APIParam vector or APIParamList of a flash descriptor)
+     * @return True if the schema is fully declared (a writer can be used), false otherwise
+     */
+    template <typename Params>
+    bool compile(const Params& params) {
+        _fields.clear();
+        _complete = compileLevel(params, 0);
+        if (!_complete) {
+            _fields.clear();
+        }
+        return _complete;
+    }
+
+    bool isComplete() const { return _complete; }
+    const std::vector<Field>& fields() const { return _fields; }
+
+private:
+    std::vector<Field> _fields;
+    bool _complete = false;
+
+    static const char* typeName(const String& type) { return type.c_str(); }
+
+    template <typename Type>
+    static const char* typeName(Type type) { return paramTypeToString(type); }
+
+    static Check checkFromType(const String& type) {
+        if (type == "boolean") return Check::Boolean;
+        if (type == "integer") return Check::Integer;
+        if (type == "number") return Check::Number;
+        if (type == "object") return Check::Object;
+        return Check::String;
+    }
+
+    template <typename Params>
+    bool compileLevel(const Params& params, uint8_t depth) {
+        for (const auto& param : params) {
+            Check check = checkFromType(typeName(param.type));
+            if (check == Check::Object && param.properties.empty()) {
+                return false;   // Object content not declared
+            }
+            size_t index = _fields.size();
+            String prefix = "\"";
+            prefix += param.name;
+            prefix += "\":";
+            _fields.push_back({param.name, prefix, check, depth, param.required, 0});
+            if (!compileLevel(param.properties, depth + 1)) {
+                return false;
+            }
+            _fields[index].subtreeSize = static_cast<uint16_t>(_fields.size() - index - 1);
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief Streams a method response as JSON text, straight into the output buffer
+ * @brief No JsonDocument is built: keys come pre-rendered from the layout and values are
+ * @brief appended as they are given. Fields must be written in declaration order; optional
+ * @brief fields can be left out. Unknown keys, wrong types and missing required fields make
+ * @brief the response fail (ok() returns false).
+ */
+class APIResponseWriter {
+public:
+    APIResponseWriter(const APIResponseLayout& layout, String& output)
+        : _fields(layout.fields()), _output(output) {
+        _output += '{';
+        _frames.push_back({0, _fields.size(), false});
+    }
+
+    /**
+     * @brief Write a scalar field (bool, integral, floating point or string)
+     * @param key Field name, as declared in the response schema
+     * @param value Field value
+     */
+    template <typename T>
+    APIResponseWriter& add(const char* key, const T& value) {
+        using V = typename std::decay<T>::type;
+        APIResponseLayout::Check check;
+        if constexpr (std::is_same<V, bool>::value) {
+            check = APIResponseLayout::Check::Boolean;
+        } else if constexpr (std::is_integral<V>::value) {
+            check = APIResponseLayout::Check::Integer;
+        } else if constexpr (std::is_floating_point<V>::value) {
+            check = APIResponseLayout::Check::Number;
+        } else {
+            static_assert(std::is_convertible<V, const char*>::value || std::is_same<V, String>::value,
+                          "Response fields must be bool, integral, floating point or string");
+            check = APIResponseLayout::Check::String;
+        }
+
+        const APIResponseLayout::Field* field = nextField(key, check);
+        if (!field) {
+            return *this;
+        }
+        _output += field->prefix;
+        if constexpr (std::is_same<V, bool>::value) {
+            _output += value ? "true" : "false";
+        } else if constexpr (std::is_integral<V>::value) {
+            char buffer[24];
+            if constexpr (std::is_signed<V>::value) {
+                snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(value));
+            } else {
+                snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(value));
+            }
+            _output += buffer;
+        } else if constexpr (std::is_floating_point<V>::value) {
+            if (std::isfinite(value)) {
+                char buffer[32];
+                snprintf(buffer, sizeof(buffer), std::is_same<V, float>::value ? "%.7g" : "%.15g",
+                         static_cast<double>(value));
+                _output += buffer;
+            } else {
+                _output += "null";
+            }
+        } else if constexpr (std::is_same<V, String>::value) {
+            appendEscaped(value.c_str());
+        } else {
+            appendEscaped(value);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Open a nested object field (close it with endObject)
+     */
+    APIResponseWriter& beginObject(const char* key) {
+        const APIResponseLayout::Field* field = nextField(key, APIResponseLayout::Check::Object);
+        if (!field) {
+            return *this;
+        }
+        _output += field->prefix;
+        _output += '{';
+        size_t first = field - _fields.data() + 1;
+        _frames.push_back({first, first + field->subtreeSize, false});
+        return *this;
+    }
+
+    /**
+     * @brief Close the current nested object
+     */
+    APIResponseWriter& endObject() {
+        if (_frames.size() <= 1) {
+            _ok = false;    // No open object
+            return *this;
+        }
+        closeFrame();
+        return *this;
+    }
+
+    /**
+     * @brief Close the response (called by the APIServer after the handler)
+     * @return True if the response is complete and matches the schema
+     */
+    bool finish() {
+        if (_frames.size() != 1) {
+            _ok = false;    // Object left open
+        }
+        while (!_frames.empty()) {
+            closeFrame();
+        }
+        return _ok;
+    }
+
+    bool ok() const { return _ok; }
+
+private:
+    struct Frame {
+        size_t cursor;              // Next field that can be written
+        size_t end;                 // End of the object fields (exclusive)
+        bool hasMembers;
+    };
+
+    const std::vector<APIResponseLayout::Field>& _fields;
+    String& _output;
+    std::vector<Frame> _frames;
+    bool _ok = true;
+
+    // Find the field of the current object matching key (declaration order), check its type
+    const APIResponseLayout::Field* nextField(const char* key, APIResponseLayout::Check check) {
+        if (!_ok || _frames.empty()) {
+            _ok = false;
+            return nullptr;
+        }
+        Frame& frame = _frames.back();
+        for (size_t i = frame.cursor; i < frame.end; i += _fields[i].subtreeSize + 1) {
+            const APIResponseLayout::Field& field = _fields[i];
+            if (field.name == key) {
+                if (field.check != check && !(field.check == APIResponseLayout::Check::Number
+                                              && check == APIResponseLayout::Check::Integer)) {
+                    break;  // Wrong type
+                }
+                if (frame.hasMembers) {
+                    _output += ',';
+                }
+                frame.hasMembers = true;
+                frame.cursor = i + field.subtreeSize + 1;
+                return &field;
+            }
+            if (field.required) {
+                break;      // Required field skipped (or unknown key)
+            }
+        }
+        _ok = false;
+        return nullptr;
+    }
+
+    void closeFrame() {
+        const Frame& frame = _frames.back();
+        for (size_t i = frame.cursor; i < frame.end; i += _fields[i].subtreeSize + 1) {
+            if (_fields[i].required) {
+                _ok = false;    // Required field missing
+                break;
+            }
+        }
+        _output += '}';
+        _frames.pop_back();
+    }
+
+    void appendEscaped(const char* str) {
+        _output += '"';
+        for (const char* c = str ? str : ""; *c; c++) {
+            switch (*c) {
+                case '"':  _output += "\\\""; break;
+                case '\\': _output += "\\\\"; break;
+                case '\n': _output += "\\n"; break;
+                case '\r': _output += "\\r"; break;
+                case '\t': _output += "\\t"; break;
+                default:
+                    if (static_cast<uint8_t>(*c) < 0x20) {
+                        char buffer[8];
+                        snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<uint8_t>(*c));
+                        _output += buffer;
+                    } else {
+                        _output += *c;
+                    }
+            }
+        }
+        _output += '"';
+    }
+};
+
+#endif // APIRESPONSEWRITER_H
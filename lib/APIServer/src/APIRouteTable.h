@@ -0,0 +1,182 @@
+#ifndef APIROUTETABLE_H
+#define APIROUTETABLE_H
+
+#include <Arduino.h>
+#include <vector>
+#include <algorithm>
+
+/**
+ * @brief Immutable route table indexed by a perfect hash (hash & displace)
+ * @brief Built once from the registry (APIServer::begin), then read-only.
+ * @brief A lookup hashes the path once, reads one displacement and one slot,
+ * @brief and compares the path bytes a single time: cost does not depend on the
+ * @brief number of registered routes.
+ * @tparam T Type of the values (pointers to the registry entries, or to their pointees, are stored)
+ */
+template <typename T>
+class APIRouteTable {
+public:
+    /**
+     * @brief Build the table from a map of String keys to T values
+     * @param entries Source map (must outlive the table and stay unmodified)
+     * @return True if a perfect hash has been found, false otherwise (table left empty)
+     */
+    template <typename Map>
+    bool build(const Map& entries) {
+        clear();
+        if (entries.empty()) {
+            _built = true;
+            return true;
+        }
+
+        _slotCount = entries.size() + entries.size() / 4 + 1;      // Load factor ~0.8
+        _bucketCount = entries.size() / KEYS_PER_BUCKET + 1;
+
+        for (uint32_t seed = 0; seed < MAX_SEEDS; seed++) {
+            if (tryBuild(entries, seed)) {
+                _seed = seed;
+                _built = true;
+                return true;
+            }
+        }
+        clear();
+        return false;
+    }
+
+    /**
+     * @brief Find a value by key
+     * @param key Key bytes (not necessarily null-terminated)
+     * @param length Key length
+     * @return A pointer to the value, or nullptr if the key is unknown
+     */
+    const T* find(const char* key, size_t length) const {
+        if (_slots.empty()) {
+            return nullptr;
+        }
+        uint32_t h = hash(key, length, _seed);
+        const Slot& slot = _slots[mix(h, _displacements[h % _bucketCount]) % _slotCount];
+        if (slot.value && slot.length == length && memcmp(slot.key, key, length) == 0) {
+            return slot.value;
+        }
+        return nullptr;
+    }
+
+    const T* find(const String& key) const {
+        return find(key.c_str(), key.length());
+    }
+
+    /**
+     * @brief True once build() succeeded (lookups are then served by the table)
+     */
+    bool isBuilt() const { return _built; }
+
+    void clear() {
+        _slots.clear();
+        _displacements.clear();
+        _built = false;
+    }
+
+private:
+    struct Slot {
+        const char* key = nullptr;
+        size_t length = 0;
+        const T* value = nullptr;
+    };
+
+    struct Candidate {
+        const char* key;
+        size_t length;
+        const T* value;
+        uint32_t hash;
+    };
+
+    static constexpr size_t KEYS_PER_BUCKET = 4;            // Average bucket size (table compactness vs build time)
+    static constexpr uint32_t MAX_SEEDS = 16;               // Attempts with a new base hash before giving up
+    static constexpr uint32_t MAX_DISPLACEMENT = 0xFFFF;    // Displacements are stored on 16 bits
+
+    std::vector<Slot> _slots;
+    std::vector<uint16_t> _displacements;                   // One per bucket
+    size_t _slotCount = 0;
+    size_t _bucketCount = 0;
+    uint32_t _seed = 0;
+    bool _built = false;
+
+    // Values stored in the map, or shared through a smart pointer
+    static const T* pointerTo(const T& value) { return &value; }
+
+    template <typename Pointer>
+    static const T* pointerTo(const Pointer& value) { return value.get(); }
+
+    // FNV-1a, seeded
+    static uint32_t hash(const char* key, size_t length, uint32_t seed) {
+        uint32_t h = 2166136261u ^ (seed * 16777619u);
+        for (size_t i = 0; i < length; i++) {
+            h ^= static_cast<uint8_t>(key[i]);
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    // Murmur3 finalizer, keyed by the bucket displacement
+    static uint32_t mix(uint32_t h, uint32_t displacement) {
+        h ^= displacement * 0x9E3779B9u;
+        h ^= h >> 16;
+        h *= 0x85EBCA6Bu;
+        h ^= h >> 13;
+        h *= 0xC2B2AE35u;
+        h ^= h >> 16;
+        return h;
+    }
+
+    template <typename Map>
+    bool tryBuild(const Map& entries, uint32_t seed) {
+        // Hash every key, then group keys by bucket
+        std::vector<std::vector<Candidate>> buckets(_bucketCount);
+        for (const auto& [key, value] : entries) {
+            uint32_t h = hash(key.c_str(), key.length(), seed);
+            buckets[h % _bucketCount].push_back({key.c_str(), key.length(), pointerTo(value), h});
+        }
+
+        // Place the largest buckets first (hardest to fit)
+        std::vector<size_t> order(_bucketCount);
+        for (size_t i = 0; i < _bucketCount; i++) order[i] = i;
+        std::sort(order.begin(), order.end(), [&buckets](size_t a, size_t b) {
+            return buckets[a].size() > buckets[b].size();
+        });
+
+        _slots.assign(_slotCount, Slot());
+        _displacements.assign(_bucketCount, 0);
+        std::vector<size_t> positions;
+
+        for (size_t b : order) {
+            const auto& bucket = buckets[b];
+            if (bucket.empty()) break;
+
+            bool placed = false;
+            for (uint32_t d = 0; d <= MAX_DISPLACEMENT && !placed; d++) {
+                positions.clear();
+                placed = true;
+                for (const auto& candidate : bucket) {
+                    size_t pos = mix(candidate.hash, d) % _slotCount;
+                    if (_slots[pos].value || std::find(positions.begin(), positions.end(), pos) != positions.end()) {
+                        placed = false;
+                        break;
+                    }
+                    positions.push_back(pos);
+                }
+                if (placed) {
+                    _displacements[b] = static_cast<uint16_t>(d);
+                    for (size_t i = 0; i < bucket.size(); i++) {
+                        _slots[positions[i]] = {bucket[i].key, bucket[i].length, bucket[i].value};
+                    }
+                }
+            }
+            if (!placed) {
+                return false;   // Identical hashes within a bucket: retry with another seed
+            }
+        }
+        return true;
+    }
+};
+
+#endif // APIROUTETABLE_H
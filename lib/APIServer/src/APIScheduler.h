@@ -0,0 +1,338 @@
+#ifndef APISCHEDULER_H
+#define APISCHEDULER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <climits>
+#include <mutex>
+
+#if !defined(ARDUINO_ARCH_ESP32)
+#include <chrono>
+#include <condition_variable>
+#endif
+
+class APIScheduler;
+
+/**
+ * @brief Deadline registered with an APIScheduler, owned by the component waiting for it
+ * @brief The scheduler sets the timer as fired when its deadline passes; the owner checks
+ * @brief fired() from its poll(). A periodic timer is re-armed by the scheduler.
+ */
+class APITimer {
+public:
+    APITimer() = default;
+    ~APITimer();
+
+    APITimer(const APITimer&) = delete;
+    APITimer& operator=(const APITimer&) = delete;
+
+    /**
+     * @brief Check if the deadline passed since the last call (any task)
+     */
+    bool fired() { return _fired.exchange(false); }
+
+    bool isArmed() const { return _armed.load(); }
+
+private:
+    friend class APIScheduler;
+
+    APIScheduler* _scheduler = nullptr;
+    APITimer* _prev = nullptr;          // Links in the slot of the wheel
+    APITimer* _next = nullptr;
+    uint32_t _deadline = 0;             // Scheduler tick
+    uint32_t _period = 0;               // Ticks, 0 = one-shot
+    std::atomic<bool> _armed{false};
+    std::atomic<bool> _fired{false};
+};
+
+/**
+ * @brief Timer wheel shared by the components, and sleep of the main loop until there is work
+ * @brief Components register deadlines (APITimer) instead of checking millis() at each loop;
+ * @brief the loop calls waitForWork(), which sleeps until the next deadline or until a task
+ * @brief calls wake() (request received, result ready, WiFi event...).
+ * @brief Hashed wheel: a timer is linked in the slot of its deadline tick, arming and
+ * @brief cancelling cost O(1), advancing visits the slots of the elapsed ticks only.
+ * @brief Timers are armed from any task (short lock); waitForWork() runs on the loop task.
+ * @brief On ESP32 the loop sleeps on a task notification, on host on a condition variable.
+ */
+class APIScheduler {
+public:
+    static constexpr unsigned long TICK_MS = 5;         // Resolution of the deadlines
+    static constexpr size_t WHEEL_SLOTS = 64;           // One turn = 320 ms, later deadlines wait for their turn
+    static constexpr unsigned long FOREVER = ULONG_MAX;
+
+    struct Stats {
+        uint32_t wakeups = 0;           // waitForWork() returns
+        uint32_t fired = 0;             // Deadlines passed
+        uint32_t sleptMs = 0;           // Time spent sleeping in waitForWork()
+    };
+
+    APIScheduler() = default;
+
+    ~APIScheduler() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& slot : _wheel) {
+            while (slot) {
+                APITimer* timer = slot;
+                unlink(*timer);
+                timer->_scheduler = nullptr;
+            }
+        }
+    }
+
+    APIScheduler(const APIScheduler&) = delete;
+    APIScheduler& operator=(const APIScheduler&) = delete;
+
+    /**
+     * @brief Arm a timer, replacing its previous deadline
+     * @param delay Delay in ms (rounded up to the tick)
+     */
+    void schedule(APITimer& timer, unsigned long delay) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        insert(timer, delay, 0);
+    }
+
+    /**
+     * @brief Arm a timer, unless it is already armed for an earlier deadline
+     * @brief (e.g. a batching window opened by the first of several events)
+     */
+    void arm(APITimer& timer, unsigned long delay) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (timer._armed.load() && static_cast<int32_t>(timer._deadline - deadlineTick(delay)) <= 0) {
+            return;
+        }
+        insert(timer, delay, 0);
+    }
+
+    /**
+     * @brief Arm a periodic timer (first deadline one period from now)
+     */
+    void every(APITimer& timer, unsigned long period) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        insert(timer, period, ticks(period));
+    }
+
+    void cancel(APITimer& timer) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (timer._armed.load()) {
+            unlink(timer);
+        }
+    }
+
+    /**
+     * @brief Ask the loop to run at once (any task): work was posted for it
+     */
+    void wake() {
+        _woken.store(true);
+#if defined(ARDUINO_ARCH_ESP32)
+        TaskHandle_t task = _task.load();
+        if (task) {
+            xTaskNotifyGive(task);
+        }
+#else
+        { std::lock_guard<std::mutex> lock(_wakeMutex); }
+        _wakeCondition.notify_one();
+#endif
+    }
+
+    /**
+     * @brief Fire the timers whose deadline passed (loop task, called by APIServer::poll)
+     * @brief The next waitForWork() then returns at once: owners polled earlier in the loop
+     * @brief see their timers at the next one.
+     * @return Number of timers fired
+     */
+    size_t advance() {
+        size_t count = fire();
+        if (count) {
+            _woken.store(true);
+        }
+        return count;
+    }
+
+    /**
+     * @brief Delay until the next deadline (ms, FOREVER if no timer is armed)
+     */
+    unsigned long nextDelay() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return nextDelayLocked();
+    }
+
+    /**
+     * @brief Sleep until the next deadline or a wake(), then fire the due timers (loop task)
+     * @brief A timer armed meanwhile for an earlier deadline ends the sleep.
+     * @param maxWait Longest sleep in ms (FOREVER = until a deadline or a wake)
+     */
+    void waitForWork(unsigned long maxWait = FOREVER) {
+        if (fire()) {
+            _stats.wakeups++;
+            return;
+        }
+        unsigned long timeout;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            timeout = nextDelayLocked();
+            if (maxWait < timeout) {
+                timeout = maxWait;
+            }
+            _sleeping = true;
+            _sleepBounded = timeout != FOREVER;
+            _sleepUntil = _sleepBounded ? deadlineTick(timeout) : 0;
+        }
+        unsigned long start = millis();
+#if defined(ARDUINO_ARCH_ESP32)
+        _task.store(xTaskGetCurrentTaskHandle());
+        if (!_woken.exchange(false) && timeout > 0) {
+            ulTaskNotifyTake(pdTRUE, timeout == FOREVER ? portMAX_DELAY : pdMS_TO_TICKS(timeout));
+            _woken.store(false);
+        }
+#else
+        if (!_woken.exchange(false) && timeout > 0) {
+            std::unique_lock<std::mutex> lock(_wakeMutex);
+            auto woken = [this]() { return _woken.exchange(false); };
+            if (timeout == FOREVER) {
+                _wakeCondition.wait(lock, woken);
+            } else {
+                _wakeCondition.wait_for(lock, std::chrono::milliseconds(timeout), woken);
+            }
+        }
+#endif
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _sleeping = false;
+        }
+        _stats.sleptMs += millis() - start;
+        _stats.wakeups++;
+        fire();
+    }
+
+    // Read from the loop task
+    const Stats& getStats() const { return _stats; }
+
+private:
+    APITimer* _wheel[WHEEL_SLOTS] = {};
+    uint32_t _tick = currentTick();         // Last tick advanced
+    std::mutex _mutex;                      // Wheel, timer links and sleep deadline
+    std::atomic<bool> _woken{false};
+    bool _sleeping = false;                 // Loop in waitForWork()
+    bool _sleepBounded = false;             // ... until _sleepUntil (tick), or until a wake
+    uint32_t _sleepUntil = 0;
+    Stats _stats;
+
+#if defined(ARDUINO_ARCH_ESP32)
+    std::atomic<TaskHandle_t> _task{nullptr};   // Loop task, known from its first waitForWork()
+#else
+    std::mutex _wakeMutex;
+    std::condition_variable _wakeCondition;
+#endif
+
+    size_t fire() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        uint32_t now = currentTick();
+        uint32_t elapsed = now - _tick;
+        if (elapsed == 0) {
+            return 0;
+        }
+        size_t count = 0;
+        size_t slots = elapsed < WHEEL_SLOTS ? elapsed : WHEEL_SLOTS;
+        for (size_t i = 1; i <= slots; i++) {
+            APITimer* timer = _wheel[(_tick + i) % WHEEL_SLOTS];
+            while (timer) {
+                APITimer* next = timer->_next;
+                if (static_cast<int32_t>(timer->_deadline - now) <= 0) {
+                    unlink(*timer);
+                    timer->_fired.store(true);
+                    count++;
+                    if (timer->_period) {
+                        // Next period from the missed deadline, or from now if several were missed
+                        uint32_t deadline = timer->_deadline + timer->_period;
+                        link(*timer, static_cast<int32_t>(deadline - now) > 0 ? deadline : now + timer->_period);
+                    }
+                }
+                timer = next;
+            }
+        }
+        _tick = now;
+        _stats.fired += count;
+        return count;
+    }
+
+    unsigned long nextDelayLocked() const {
+        bool found = false;
+        uint32_t next = 0;
+        for (size_t i = 1; i <= WHEEL_SLOTS; i++) {
+            for (APITimer* timer = _wheel[(_tick + i) % WHEEL_SLOTS]; timer; timer = timer->_next) {
+                if (!found || static_cast<int32_t>(timer->_deadline - next) < 0) {
+                    next = timer->_deadline;
+                    found = true;
+                }
+            }
+            // Slots are visited in deadline order within the turn: the first match is the earliest
+            if (found && next == _tick + i) {
+                break;
+            }
+        }
+        if (!found) {
+            return FOREVER;
+        }
+        int32_t remaining = static_cast<int32_t>(static_cast<uint32_t>(next * TICK_MS) - static_cast<uint32_t>(millis()));
+        return remaining > 0 ? static_cast<unsigned long>(remaining) : 0;
+    }
+
+    static uint32_t currentTick() { return static_cast<uint32_t>(millis() / TICK_MS); }
+    static uint32_t ticks(unsigned long ms) { return static_cast<uint32_t>((ms + TICK_MS - 1) / TICK_MS); }
+
+    // Deadline of a delay from now: at least the next tick not advanced yet
+    uint32_t deadlineTick(unsigned long delay) const {
+        uint32_t deadline = static_cast<uint32_t>((millis() + delay + TICK_MS - 1) / TICK_MS);
+        return static_cast<int32_t>(deadline - _tick) > 0 ? deadline : _tick + 1;
+    }
+
+    void insert(APITimer& timer, unsigned long delay, uint32_t period) {
+        if (timer._armed.load()) {
+            unlink(timer);
+        }
+        timer._scheduler = this;
+        timer._period = period;
+        timer._fired.store(false);
+        link(timer, deadlineTick(delay));
+        if (_sleeping && (!_sleepBounded || static_cast<int32_t>(timer._deadline - _sleepUntil) < 0)) {
+            wake();     // The loop sleeps past this deadline
+        }
+    }
+
+    void link(APITimer& timer, uint32_t deadline) {
+        if (static_cast<int32_t>(deadline - _tick) <= 0) {
+            deadline = _tick + 1;
+        }
+        timer._deadline = deadline;
+        APITimer*& slot = _wheel[deadline % WHEEL_SLOTS];
+        timer._prev = nullptr;
+        timer._next = slot;
+        if (slot) {
+            slot->_prev = &timer;
+        }
+        slot = &timer;
+        timer._armed.store(true);
+    }
+
+    void unlink(APITimer& timer) {
+        if (timer._prev) {
+            timer._prev->_next = timer._next;
+        } else {
+            _wheel[timer._deadline % WHEEL_SLOTS] = timer._next;
+        }
+        if (timer._next) {
+            timer._next->_prev = timer._prev;
+        }
+        timer._prev = timer._next = nullptr;
+        timer._armed.store(false);
+    }
+};
+
+inline APITimer::~APITimer() {
+    if (_scheduler) {
+        _scheduler->cancel(*this);
+    }
+}
+
+#endif // APISCHEDULER_H
@@ -6,7 +6,24 @@
 #include <vector>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <iterator>
+#include <optional>
+#include <type_traits>
 #include "APIEndpoint.h"
+#include "APIRouteTable.h"
+#include "APIValidationPlan.h"
+#include "APIResponseWriter.h"
+#include "APIPendingResponse.h"
+#include "APIWorker.h"
+#include "APISnapshot.h"
+#include "APIResponseCache.h"
+#include "APISingleFlight.h"
+#include "APISubscriptions.h"
+#include "APIMergePatch.h"
+#include "APIScheduler.h"
+#include "APIMetrics.h"
+#include "APITrace.h"
 
 // Forward declarations of API endpoints implementations
 class WebAPIEndpoint;
@@ -137,6 +154,197 @@ constexpr const char* paramTypeToString(APIParamType type) {
 
 
 
+//##############################################################################
+//                     Flash-resident method descriptors
+//##############################################################################
+
+// Schema errors found while evaluating a constexpr descriptor. These functions are not
+// constexpr: reaching one fails the compilation, with its name in the error message.
+inline void API_SCHEMA_ERROR_limits_only_allowed_on_numbers_and_strings() {}
+inline void API_SCHEMA_ERROR_min_greater_than_max() {}
+inline void API_SCHEMA_ERROR_empty_param_name() {}
+inline void API_SCHEMA_ERROR_request_params_on_event() {}
+inline void API_SCHEMA_ERROR_cache_only_allowed_on_get() {}
+inline void API_SCHEMA_ERROR_coalesce_only_allowed_on_events() {}
+inline void API_SCHEMA_ERROR_delta_only_allowed_on_events() {}
+
+struct APIParamDescriptor;
+
+/**
+ * @brief Non-owning list of parameter descriptors (static array)
+ */
+struct APIParamList {
+    const APIParamDescriptor* items = nullptr;
+    size_t count = 0;
+
+    constexpr APIParamList() = default;
+    template <size_t N>
+    constexpr APIParamList(const APIParamDescriptor (&array)[N]) : items(array), count(N) {}
+
+    constexpr const APIParamDescriptor* begin() const { return items; }
+    constexpr const APIParamDescriptor* end() const;
+    constexpr bool empty() const { return count == 0; }
+    constexpr size_t size() const { return count; }
+};
+
+/**
+ * @brief Parameter of a method descriptor (literal type, same options as APIParam)
+ * @brief Invalid schemas (limits on a Boolean/Object, min > max, empty name) do not compile.
+ */
+struct APIParamDescriptor {
+    const char* name;
+    APIParamType type;
+    bool required = true;
+    bool hasLimits = false;
+    float min = 0;
+    float max = 0;
+    APIParamList properties;            // Nested object properties
+
+    // Simple parameter (r optional)
+    constexpr APIParamDescriptor(const char* n, APIParamType t, bool r = true)
+        : name(n), type(t), required(r) {
+        checkName();
+    }
+
+    // Parameter with limits (value range for numbers, length range for strings)
+    constexpr APIParamDescriptor(const char* n, APIParamType t, float minValue, float maxValue, bool r = true)
+        : name(n), type(t), required(r), hasLimits(true), min(minValue), max(maxValue) {
+        checkName();
+        if (t == APIParamType::Boolean || t == APIParamType::Object) {
+            API_SCHEMA_ERROR_limits_only_allowed_on_numbers_and_strings();
+        }
+        if (minValue > maxValue) {
+            API_SCHEMA_ERROR_min_greater_than_max();
+        }
+    }
+
+    // Nested object (properties declared in another static array)
+    constexpr APIParamDescriptor(const char* n, APIParamList props, bool r = true)
+        : name(n), type(APIParamType::Object), required(r), properties(props) {
+        checkName();
+    }
+
+private:
+    constexpr void checkName() const {
+        if (!name || !name[0]) {
+            API_SCHEMA_ERROR_empty_param_name();
+        }
+    }
+};
+
+constexpr const APIParamDescriptor* APIParamList::end() const { return items + count; }
+
+/**
+ * @brief Method descriptor, built at compile time (declare it static constexpr: it stays in flash)
+ * @brief Holds the schema of a method: only the handler is stored in RAM at registration.
+ * @brief Example:
+ * @brief   static constexpr APIParamDescriptor PARAMS[] = {{"hostname", APIParamType::String}};
+ * @brief   static constexpr APIMethodDescriptor DESC =
+ * @brief       APIMethodDescriptor(APIMethodType::SET, "Set device hostname").params(PARAMS);
+ */
+struct APIMethodDescriptor {
+    APIMethodType type;
+    const char* description = "";
+    APIParamList requestParams;
+    APIParamList responseParams;
+    const char* const* exclusions = nullptr;    // Excluded protocols
+    size_t exclusionCount = 0;
+    bool hidden = false;
+    bool cached = false;                        // GET: response cached (see APIResponseCache)
+    uint32_t cacheTTL = 0;                      // Lifetime of the cached response (ms, 0 = until invalidated)
+    const char* const* cacheKeys = nullptr;     // Invalidation keys of the cached response
+    size_t cacheKeyCount = 0;
+    const char* const* invalidations = nullptr; // Keys invalidated after a successful call
+    size_t invalidationCount = 0;
+    uint32_t coalesceWindow = 0;                // EVT: latest value wins within this window (ms)
+    bool delta = false;                         // EVT: sent as a merge-patch of the previous value
+    APIPriority priorityClass = APIPriority::Interactive;  // Scheduling class of queued requests and events
+
+    constexpr APIMethodDescriptor(APIMethodType t, const char* desc = "") : type(t), description(desc) {}
+
+    constexpr APIMethodDescriptor params(APIParamList list) const {
+        if (type == APIMethodType::EVT && !list.empty()) {
+            API_SCHEMA_ERROR_request_params_on_event();
+        }
+        APIMethodDescriptor d = *this;
+        d.requestParams = list;
+        return d;
+    }
+
+    constexpr APIMethodDescriptor response(APIParamList list) const {
+        APIMethodDescriptor d = *this;
+        d.responseParams = list;
+        return d;
+    }
+
+    template <size_t N>
+    constexpr APIMethodDescriptor excl(const char* const (&protocols)[N]) const {
+        APIMethodDescriptor d = *this;
+        d.exclusions = protocols;
+        d.exclusionCount = N;
+        return d;
+    }
+
+    constexpr APIMethodDescriptor hide(bool value = true) const {
+        APIMethodDescriptor d = *this;
+        d.hidden = value;
+        return d;
+    }
+
+    constexpr APIMethodDescriptor cache(uint32_t ttl = 0) const {
+        if (type != APIMethodType::GET) {
+            API_SCHEMA_ERROR_cache_only_allowed_on_get();
+        }
+        APIMethodDescriptor d = *this;
+        d.cached = true;
+        d.cacheTTL = ttl;
+        return d;
+    }
+
+    template <size_t N>
+    constexpr APIMethodDescriptor cache(uint32_t ttl, const char* const (&keys)[N]) const {
+        APIMethodDescriptor d = cache(ttl);
+        d.cacheKeys = keys;
+        d.cacheKeyCount = N;
+        return d;
+    }
+
+    template <size_t N>
+    constexpr APIMethodDescriptor invalidates(const char* const (&keys)[N]) const {
+        APIMethodDescriptor d = *this;
+        d.invalidations = keys;
+        d.invalidationCount = N;
+        return d;
+    }
+
+    constexpr APIMethodDescriptor coalesce(uint32_t window) const {
+        if (type != APIMethodType::EVT) {
+            API_SCHEMA_ERROR_coalesce_only_allowed_on_events();
+        }
+        APIMethodDescriptor d = *this;
+        d.coalesceWindow = window;
+        return d;
+    }
+
+    constexpr APIMethodDescriptor deltaEncoded(bool value = true) const {
+        if (type != APIMethodType::EVT) {
+            API_SCHEMA_ERROR_delta_only_allowed_on_events();
+        }
+        APIMethodDescriptor d = *this;
+        d.delta = value;
+        return d;
+    }
+
+    constexpr APIMethodDescriptor priority(APIPriority value) const {
+        APIMethodDescriptor d = *this;
+        d.priorityClass = value;
+        return d;
+    }
+};
+
+
+
+
 //##############################################################################
 //                             API builder
 //##############################################################################
@@ -184,6 +392,16 @@ struct APIParam {
     // Constructor for nested objects
     APIParam(const String& n, const std::initializer_list<APIParam>& props, bool r = true)
         : name(n), type(paramTypeToString(APIParamType::Object)), required(r), properties(props) {}
+
+    // Copy of a flash descriptor (documentation rendering)
+    explicit APIParam(const APIParamDescriptor& d)
+        : name(d.name), type(paramTypeToString(d.type)), required(d.required),
+          min(d.min), max(d.max), hasLimits(d.hasLimits)
+    {
+        for (const auto& prop : d.properties) {
+            properties.push_back(APIParam(prop));
+        }
+    }
 };
 
 struct APIBasicAuth {
@@ -192,23 +410,82 @@ struct APIBasicAuth {
     String password;
 };
 
+/**
+ * @brief Cache policy of a GET method (see APIResponseCache)
+ */
+struct APICachePolicy {
+    bool enabled = false;
+    uint32_t ttl = 0;                   // Lifetime of the cached response (ms, 0 = until invalidated)
+    std::vector<String> keys;           // Invalidation keys, besides the method path
+};
+
 /**
  * @brief API method data
  */
 
 struct APIMethod {
     using Handler = std::function<bool(const JsonObject* args, JsonObject& response)>;
+    using WriterHandler = std::function<bool(const JsonObject* args, APIResponseWriter& writer)>;
+    using DeferredHandler = std::function<APIPendingResponse(const JsonObject* args)>;
     
     APIMethodType type;                     // GET, SET, EVT (event) 
     Handler handler;                        // Function to execute when the method is called
+    WriterHandler writer;                   // Or: function streaming the response (responseParams fully declared)
+    DeferredHandler deferred;               // Or: function returning a token completed later (slow operations)
     String description;                     // Description of the method
     std::vector<APIParam> requestParams;    // Parameters of the request
     std::vector<APIParam> responseParams;   // Parameters of the response
     std::vector<String> exclusions;         // Liste des protocoles exclus
+    uint32_t exclusionMask = 0;             // Excluded protocol IDs (bit n = protocol n), set by registerMethod
     bool hidden = false;                    // Si true, la méthode n'apparaît pas dans la doc
     APIBasicAuth auth;                      // Basic auth settings if enabled
+    APICachePolicy cache;                   // GET: response kept until TTL or invalidation (descriptor: keys in flash)
+    std::vector<String> invalidates;        // Cache keys invalidated after a successful call (descriptor: in flash)
+    uint32_t coalesceWindow = 0;            // EVT: latest value wins within this window (ms, 0 = sent at once)
+    bool delta = false;                     // EVT: sent as a merge-patch of the previous value, with a sequence number
+    APIPriority priority = APIPriority::Interactive;  // Scheduling class of its queued requests and events
+    const APIMethodDescriptor* descriptor = nullptr;  // Flash schema (replaces description/params/exclusions)
+    APIValidationPlan validation;           // Request checks compiled from the request schema, set by registerMethod (keys point into it)
+    APIResponseLayout responseLayout;       // Response keys compiled from responseParams (writer only), set by registerMethod
+    std::shared_ptr<APIMethodMetrics> metrics;  // Call counters and phase latencies, set by registerMethod (shared by the snapshots)
+
+    // Check if the method is excluded for a protocol (single AND on the mask)
+    bool isExcludedFor(uint8_t protocolId) const {
+        return protocolId < APIEndpoint::MAX_PROTOCOLS && (exclusionMask & (1u << protocolId));
+    }
+
+    // Description, from the descriptor if any
+    String getDescription() const {
+        return descriptor ? String(descriptor->description) : description;
+    }
+
+    // Request schema (copied from the descriptor if any: for documentation, not hot paths)
+    std::vector<APIParam> getRequestParams() const {
+        return descriptor ? toParams(descriptor->requestParams) : requestParams;
+    }
+
+    // Response schema (copied from the descriptor if any: for documentation, not hot paths)
+    std::vector<APIParam> getResponseParams() const {
+        return descriptor ? toParams(descriptor->responseParams) : responseParams;
+    }
+
+private:
+    static std::vector<APIParam> toParams(const APIParamList& list) {
+        std::vector<APIParam> params;
+        for (const auto& d : list) {
+            params.push_back(APIParam(d));
+        }
+        return params;
+    }
 };
 
+/**
+ * @brief Registered method, shared by the registry snapshots
+ * @brief Built and compiled once by registerMethod, then never modified nor copied: the
+ * @brief validation plan keeps pointing into its own schema whatever the snapshot.
+ */
+using APIMethodRef = std::shared_ptr<const APIMethod>;
+
 /**
  * @brief Builder of an APIMethod.
  * @brief APIMethods are registered in the APIServer and can be used by endpoints.
@@ -223,6 +500,18 @@ public:
         _method.handler = handler;
     }
     
+    // Constructor for GET/SET with a response writer (JSON streamed without JsonDocument)
+    APIMethodBuilder(APIMethodType type, APIMethod::WriterHandler writer) {
+        _method.type = type;
+        _method.writer = writer;
+    }
+    
+    // Constructor for GET/SET with a deferred handler (response completed later, from poll())
+    APIMethodBuilder(APIMethodType type, APIMethod::DeferredHandler deferred) {
+        _method.type = type;
+        _method.deferred = deferred;
+    }
+    
     // Overloaded constructor for EVT (no need for handler)
     APIMethodBuilder(APIMethodType type) {
         if (type != APIMethodType::EVT) {
@@ -296,6 +585,46 @@ public:
         return *this;
     }
 
+    // Cache the response of this GET method (ttl in ms, 0 = until invalidated)
+    APIMethodBuilder& cache(uint32_t ttl = 0) {
+        _method.cache.enabled = true;
+        _method.cache.ttl = ttl;
+        return *this;
+    }
+
+    // Cache the response of this GET method, also invalidated by these keys
+    APIMethodBuilder& cache(uint32_t ttl, const std::initializer_list<String>& keys) {
+        cache(ttl);
+        for (const auto& key : keys) {
+            _method.cache.keys.push_back(key);
+        }
+        return *this;
+    }
+
+    // Invalidate cached responses after a successful call (method path or cache key)
+    APIMethodBuilder& invalidates(const String& key) {
+        _method.invalidates.push_back(key);
+        return *this;
+    }
+
+    // Coalesce this event: broadcasts within the window are merged, the latest value is sent
+    APIMethodBuilder& coalesce(uint32_t window) {
+        _method.coalesceWindow = window;
+        return *this;
+    }
+
+    // Send this event as a JSON merge-patch of its previous value (clients resync on a sequence gap)
+    APIMethodBuilder& deltaEncoded(bool value = true) {
+        _method.delta = value;
+        return *this;
+    }
+
+    // Scheduling class: queued requests and events of control methods are served first
+    APIMethodBuilder& priority(APIPriority value) {
+        _method.priority = value;
+        return *this;
+    }
+
     // Eventually, build the method
     APIMethod build() {
         return _method;
@@ -305,36 +634,429 @@ private:
     APIMethod _method;  // Stores the method during construction
 };
 
+/**
+ * @brief Schema type of a C++ field bound by APITypedMethodBuilder (checked at compile time)
+ * @brief bool -> Boolean, integral -> Integer, floating point -> Number, String -> String.
+ * @brief std::optional<T> maps like T and makes the parameter optional by default.
+ */
+template <typename T>
+struct APIFieldTraits {
+    static_assert(std::is_same<T, bool>::value || std::is_arithmetic<T>::value || std::is_same<T, String>::value,
+                  "Typed API fields must be bool, integral, floating point, String or std::optional of these");
+    using ValueType = T;
+    static constexpr bool optional = false;
+    static constexpr APIParamType type =
+        std::is_same<T, bool>::value ? APIParamType::Boolean :
+        std::is_integral<T>::value ? APIParamType::Integer :
+        std::is_floating_point<T>::value ? APIParamType::Number : APIParamType::String;
+};
+
+template <typename T>
+struct APIFieldTraits<std::optional<T>> : APIFieldTraits<T> {
+    static constexpr bool optional = true;
+};
+
+/**
+ * @brief Builder of an APIMethod whose handler receives a decoded C++ struct
+ * @brief Each parameter is bound to a field of Args (member pointer): the schema type is
+ * @brief deduced from the field type and a misspelled field does not compile.
+ * @brief Arguments are decoded once, in a single pass over the JSON members, after the
+ * @brief APIServer validated them against the schema (types are then guaranteed).
+ * @tparam Args Default-constructible struct of the request arguments
+ */
+template <typename Args>
+class APITypedMethodBuilder {
+public:
+    using Handler = std::function<bool(const Args& args, JsonObject& response)>;
+
+    APITypedMethodBuilder(APIMethodType type, Handler handler)
+        : _builder(type, APIMethod::Handler()), _handler(handler) {}
+
+    APITypedMethodBuilder& desc(const String& description) {
+        _builder.desc(description);
+        return *this;
+    }
+
+    // Bind a parameter to a field (required unless the field is a std::optional)
+    template <typename T>
+    APITypedMethodBuilder& param(const String& name, T Args::* field) {
+        return param(name, field, !APIFieldTraits<T>::optional);
+    }
+
+    // Bind a parameter to a field, explicit required
+    template <typename T>
+    APITypedMethodBuilder& param(const String& name, T Args::* field, bool required) {
+        _builder.param(name, APIFieldTraits<T>::type, required);
+        bind(name, field);
+        return *this;
+    }
+
+    // Bind a parameter to a field, with limits (required unless the field is a std::optional)
+    template <typename T>
+    APITypedMethodBuilder& param(const String& name, T Args::* field, const std::initializer_list<float>& limits) {
+        return param(name, field, limits, !APIFieldTraits<T>::optional);
+    }
+
+    // Bind a parameter to a field, with limits + explicit required
+    template <typename T>
+    APITypedMethodBuilder& param(const String& name, T Args::* field, const std::initializer_list<float>& limits, bool required) {
+        _builder.param(name, APIFieldTraits<T>::type, limits, required);
+        bind(name, field);
+        return *this;
+    }
+
+    APITypedMethodBuilder& response(const String& name, APIParamType type, bool required = true) {
+        _builder.response(name, type, required);
+        return *this;
+    }
+
+    APITypedMethodBuilder& response(const String& name, const std::initializer_list<APIParam>& props, bool required = true) {
+        _builder.response(name, props, required);
+        return *this;
+    }
+
+    APITypedMethodBuilder& excl(const String& protocol) {
+        _builder.excl(protocol);
+        return *this;
+    }
+
+    APITypedMethodBuilder& excl(const std::initializer_list<String>& protocols) {
+        _builder.excl(protocols);
+        return *this;
+    }
+
+    APITypedMethodBuilder& hide(bool value = true) {
+        _builder.hide(value);
+        return *this;
+    }
+
+    APITypedMethodBuilder& basicauth(const String& user, const String& password) {
+        _builder.basicauth(user, password);
+        return *this;
+    }
+
+    APITypedMethodBuilder& invalidates(const String& key) {
+        _builder.invalidates(key);
+        return *this;
+    }
+
+    APITypedMethodBuilder& priority(APIPriority value) {
+        _builder.priority(value);
+        return *this;
+    }
+
+    // Eventually, build the method (the JSON handler decodes Args then calls the typed handler)
+    APIMethod build() {
+        APIMethod method = _builder.build();
+        method.handler = [bindings = _bindings, handler = _handler](const JsonObject* args, JsonObject& response) {
+            Args decoded{};
+            if (args) {
+                for (JsonPairConst member : JsonObjectConst(*args)) {
+                    const char* key = member.key().c_str();
+                    for (const auto& binding : bindings) {
+                        if (strcmp(binding.name.c_str(), key) == 0) {
+                            binding.assign(decoded, member.value());
+                            break;
+                        }
+                    }
+                }
+            }
+            return handler(decoded, response);
+        };
+        return method;
+    }
+
+private:
+    struct Binding {
+        String name;
+        std::function<void(Args&, JsonVariantConst)> assign;
+    };
+
+    APIMethodBuilder _builder;          // Schema & options of the method
+    Handler _handler;
+    std::vector<Binding> _bindings;     // Field setters, by parameter name
+
+    template <typename T>
+    void bind(const String& name, T Args::* field) {
+        using ValueType = typename APIFieldTraits<T>::ValueType;
+        _bindings.push_back({name, [field](Args& args, JsonVariantConst value) {
+            if (!value.isNull()) {
+                args.*field = value.as<ValueType>();
+            }
+        }});
+    }
+};
+
 
 
 //##############################################################################
 //                             API server definition
 //##############################################################################
 
+/**
+ * @brief Registry of the API server: methods, modules, endpoints and protocols
+ * @brief Published as an immutable snapshot (APISnapshot): requests read it without lock,
+ * @brief registrations publish a modified copy.
+ */
+struct APIRegistry {
+    std::map<String, APIModuleInfo> modules;    // API module metadata (includes list of routes)
+    std::map<String, APIMethodRef> methods;     // Registered methods by path (shared by the snapshots)
+    std::vector<APIEndpoint*> endpoints;        // Objects implementing APIEndpoint
+    std::vector<String> protocolNames;          // Known protocols, indexed by protocol ID
+    APIRouteTable<APIMethod> routes;            // Perfect-hash lookup table over methods (built in begin())
+
+    APIRegistry() = default;
+
+    // Copies share the methods and get their own route table (the source one points into the source map)
+    APIRegistry(const APIRegistry& other)
+        : modules(other.modules), methods(other.methods), endpoints(other.endpoints),
+          protocolNames(other.protocolNames) {
+        if (other.routes.isBuilt()) {
+            buildRoutes();
+        }
+    }
+
+    APIRegistry& operator=(const APIRegistry&) = delete;
+
+    /**
+     * @brief Build the perfect-hash route table from the methods
+     */
+    void buildRoutes() {
+        if (!routes.build(methods)) {
+            Serial.println("APISERVER: Echec de la construction de la table de routes, recherche par map");
+        }
+    }
+
+    /**
+     * @brief Resolve a path to its method (route table once built, map before begin())
+     */
+    const APIMethod* lookup(const String& path) const {
+        if (routes.isBuilt()) {
+            return routes.find(path);
+        }
+        auto it = methods.find(path);
+        return it != methods.end() ? it->second.get() : nullptr;
+    }
+
+    uint8_t protocolId(const String& protocol) const {
+        for (size_t i = 0; i < protocolNames.size(); i++) {
+            if (protocolNames[i] == protocol) {
+                return static_cast<uint8_t>(i);
+            }
+        }
+        return APIEndpoint::NO_PROTOCOL_ID;
+    }
+};
+
+/**
+ * @brief View over the registered methods of a registry snapshot, filtered by protocol
+ * @brief Excluded methods are skipped lazily while iterating: nothing is copied. The view
+ * @brief holds a reader, so the snapshot stays valid while it exists (keep it short-lived:
+ * @brief registrations wait for it).
+ * @brief Iterates in path order over (path, method) pairs, like the registry map.
+ */
+class APIMethodView {
+public:
+    using Map = std::map<String, APIMethodRef>;
+
+    class iterator {
+    public:
+        using value_type = std::pair<const String&, const APIMethod&>;
+        using reference = value_type;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::input_iterator_tag;
+
+        iterator(Map::const_iterator it, Map::const_iterator end, uint8_t protocolId)
+            : _it(it), _end(end), _protocolId(protocolId) { skipExcluded(); }
+
+        reference operator*() const { return {_it->first, *_it->second}; }
+        iterator& operator++() { ++_it; skipExcluded(); return *this; }
+        bool operator==(const iterator& other) const { return _it == other._it; }
+        bool operator!=(const iterator& other) const { return _it != other._it; }
+
+    private:
+        Map::const_iterator _it;
+        Map::const_iterator _end;
+        uint8_t _protocolId;
+
+        void skipExcluded() {
+            while (_it != _end && _it->second->isExcludedFor(_protocolId)) {
+                ++_it;
+            }
+        }
+    };
+
+    APIMethodView(APISnapshot<APIRegistry>::Reader registry, uint8_t protocolId)
+        : _registry(std::move(registry)), _protocolId(protocolId) {}
+
+    iterator begin() const { return iterator(_registry->methods.begin(), _registry->methods.end(), _protocolId); }
+    iterator end() const { return iterator(_registry->methods.end(), _registry->methods.end(), _protocolId); }
+    bool empty() const { return begin() == end(); }
+
+private:
+    APISnapshot<APIRegistry>::Reader _registry;
+    uint8_t _protocolId;
+};
+
 /**
  * @brief Main API Server
  */
 class APIServer {
 public:
+    using DocRenderer = std::function<void(String& output)>;
+    using DocRendering = std::shared_ptr<const String>;
+    using DocSource = std::function<DocRendering()>;
+    using Completion = APIWorker::Completion;
+    using RegistryReader = APISnapshot<APIRegistry>::Reader;
+
+    static constexpr size_t MAX_PENDING_RESPONSES = 8;         // Deferred requests in progress
+    static constexpr size_t ASYNC_REQUEST_CAPACITY = 8;        // Deferred/batch requests waiting for poll(), per priority class
+    static constexpr unsigned long DEFERRED_TIMEOUT = 30000;   // Deferred requests fail after this delay (ms)
+    static constexpr unsigned long PENDING_CHECK_INTERVAL = 20; // Deferred requests in progress checked at this interval (ms)
+    static constexpr const char* BATCH_PATH = "_batch";        // Reserved path of batch requests
+    static constexpr size_t MAX_BATCH_CALLS = 16;              // Calls in one batch
+    static constexpr const char* METRICS_MODULE = "sys";       // Module of the built-in methods
+    static constexpr const char* METRICS_PATH = "sys/metrics"; // Built-in method serving the call metrics
+    static constexpr const char* TRACES_PATH = "sys/traces";   // Built-in method serving the last traces
+    static constexpr const char* TRACES_CONFIG_PATH = "sys/traces/config"; // Built-in method turning tracing on/off
+
+    static constexpr const char* DOC_FORMAT_JSON = "json";
+    static constexpr const char* DOC_ETAG_SUFFIX = ".etag";    // Cache key of a rendering's ETag: format + suffix
+
     /**
      * @brief Initialize all endpoints
      */
     void begin() {
+        registerMetricsMethod();
+        registerTraceMethods();
+
+        // Freeze the registry into the route table used by all lookups: the registrations
+        // made so far were applied in place, the registry is published here once
+        _started = true;
+        _registry.update([](APIRegistry& registry) {
+            registry.buildRoutes();
+        });
+
+        if (_worker) {
+            _worker->begin();
+        }
+
         Serial.println("APISERVER: Démarrage des endpoints...");
-        for (APIEndpoint* endpoint : _endpoints) {
+        RegistryReader registry = readRegistry();
+        for (APIEndpoint* endpoint : registry->endpoints) {
             endpoint->begin();
         }
     }
 
     /**
-     * @brief Poll endpoints for client requests
+     * @brief Poll endpoints for client requests, then hand back the results and queued work
+     * @param budgetUs Time budget of the endpoints (µs, 0 = unlimited). It is split by the
+     * endpoint weights (APIEndpoint::setPollWeight), the time left by an endpoint going to the
+     * next ones; the first endpoint served rotates at each call. Endpoints yield when their slice
+     * is spent, overruns are recorded in their PollStats (APIEndpoint::getPollStats).
      */
-    void poll() {
-        for (APIEndpoint* endpoint : _endpoints) {
-            endpoint->poll();
+    void poll(unsigned long budgetUs = 0) {
+        _scheduler.advance();
+        {
+            RegistryReader registry = readRegistry();
+            if (budgetUs == 0) {
+                for (APIEndpoint* endpoint : registry->endpoints) {
+                    endpoint->poll();
+                }
+            } else {
+                pollEndpoints(registry->endpoints, budgetUs);
+            }
+        }
+        if (_worker) {
+            _worker->dispatchCompletions();
+        }
+        processAsyncRequests();
+        processPendingResponses();
+        flushCoalescedEvents();
+        _registry.reclaim();    // Snapshots replaced by registrations, once their readers are gone
+    }
+
+    /**
+     * @brief Timer wheel of the components, and sleep of the main loop until there is work
+     * @brief Endpoints and modules register their deadlines with it; loop() calls
+     * @brief scheduler().waitForWork() before polling (see APIScheduler).
+     */
+    APIScheduler& scheduler() {
+        return _scheduler;
+    }
+
+    /**
+     * @brief Traces of the requests and events (off by default: tracer().setEnabled(true))
+     * @brief Endpoints start a trace per request and stamp its stages, the server stamps
+     * @brief validation, handler and serialization; the last ones are served by sys/traces.
+     */
+    APITracer& tracer() {
+        return _tracer;
+    }
+
+    /**
+     * @brief Write the last finished traces as JSON, oldest first (served by sys/traces)
+     * @param output Receives one object per trace, with the offset of each stage reached (µs)
+     */
+    void getTraces(JsonArray& output) const {
+        RegistryReader registry = readRegistry();
+        for (const APITraceRecord& record : _tracer.getTraces()) {
+            JsonObject trace = output.add<JsonObject>();
+            trace["id"] = record.id;
+            trace["path"] = record.path;
+            if (record.event) {
+                trace["event"] = true;
+            } else if (record.protocolId < registry->protocolNames.size()) {
+                trace["protocol"] = registry->protocolNames[record.protocolId];
+            }
+            trace["success"] = record.success;
+            uint32_t total = 0;
+            JsonObject stages = trace["stages"].to<JsonObject>();
+            for (size_t i = 0; i < API_STAGE_COUNT; i++) {
+                APIStage stage = static_cast<APIStage>(i);
+                if (record.hasStage(stage)) {
+                    stages[apiStageToString(stage)] = record.offset(stage);
+                    total = record.offset(stage) > total ? record.offset(stage) : total;
+                }
+            }
+            trace["totalUs"] = total;
+        }
+    }
+
+    /**
+     * @brief Run the handlers on a worker task instead of the transport tasks (call before begin)
+     * @brief Requests then go through executeMethodAsync only: the endpoints post them and get the
+     * @brief results from poll(). Handlers must not race with code touching the same state from loop().
+     * @param worker Worker task (nullptr = handlers run in the caller's task)
+     */
+    void setWorker(APIWorker* worker) {
+        _worker = worker;
+        if (_worker) {
+            _worker->setExecutor([this](uint8_t protocolId, const String& path, const JsonObject* args, JsonObject& response) {
+                return executeMethod(protocolId, path, args, response);
+            });
+            _worker->setResultNotifier([this]() {
+                _scheduler.wake();      // Results handed back from poll()
+            });
         }
     }
 
+    /**
+     * @brief Check if the handlers run on a worker task (endpoints then use executeMethodAsync)
+     */
+    bool hasWorker() const {
+        return _worker && _worker->isRunning();
+    }
+
+    /**
+     * @brief Check if an identical GET call is running synchronously in another task
+     * @brief Endpoints on a shared task then use executeMethodAsync: completed by that call
+     * @brief instead of running the handler again (and never waiting for it).
+     */
+    bool isCallRunning(const String& path, const JsonObject* args) const {
+        return _syncFlights.running(APISingleFlight<String>::key(path, args));
+    }
+
     /**
      * @brief Register the API metadata (from parameters)
      * @param title The title of the API
@@ -345,6 +1067,7 @@ public:
         _apiInfo.title = title;
         _apiInfo.version = version;
         _apiInfo.serverUrl = serverUrl;
+        invalidateDocs();
     }
 
     /**
@@ -353,6 +1076,7 @@ public:
      */
     void registerAPIInfo(const APIInfo& apiInfo) {
         _apiInfo = apiInfo;
+        invalidateDocs();
     }
 
     /**
@@ -362,7 +1086,12 @@ public:
      * @param version The version of the module
      */
     void registerModuleInfo(const String& name, const String& description, const String& version = "") {
-        _modules[name] = {description, version};
+        updateRegistry([&](APIRegistry& registry) {
+            APIModuleInfo& info = registry.modules[name];
+            info.description = description;
+            info.version = version;
+        });
+        invalidateDocs();
     }
 
     /**
@@ -372,47 +1101,503 @@ public:
      * @param method The method to register
      */
     void registerMethod(const String& module, const String& path, const APIMethod& method) {
-        // Register the method
-        _methods[path] = method;
+        APICachePolicy cachePolicy;
+
+        // Published as a new registry snapshot: requests in progress keep the previous one
+        updateRegistry([&](APIRegistry& registry) {
+            // Register the method, with its exclusions resolved to protocol IDs
+            auto shared = std::make_shared<APIMethod>(method);
+            APIMethod& registered = *shared;
+            registered.metrics = std::make_shared<APIMethodMetrics>();
+            if (registered.descriptor) {
+                const APIMethodDescriptor& d = *registered.descriptor;
+                compileMethod(path, registered, d.requestParams, d.responseParams);
+                for (size_t i = 0; i < d.exclusionCount; i++) {
+                    excludeProtocol(registry, registered, d.exclusions[i]);
+                }
+                registered.cache.enabled = d.cached;
+                registered.cache.ttl = d.cacheTTL;
+                registered.coalesceWindow = d.coalesceWindow;
+                registered.delta = d.delta;
+                registered.priority = d.priorityClass;
+            } else {
+                compileMethod(path, registered, registered.requestParams, registered.responseParams);
+                for (const auto& excl : registered.exclusions) {
+                    excludeProtocol(registry, registered, excl);
+                }
+            }
 
-        // Add the route to module metadata
-        auto it = _modules.find(module);
-        if (it != _modules.end()) {
-            it->second.routes.push_back(path);
-        }
+            // Only synchronous GET responses can be cached
+            if (registered.cache.enabled && (registered.type != APIMethodType::GET || registered.deferred)) {
+                Serial.printf("APISERVER: Cache ignoré pour %s (GET synchrone uniquement)\n", path.c_str());
+                registered.cache.enabled = false;
+            }
+            cachePolicy = registered.cache;
+            if (registered.descriptor) {
+                // Copied for the cache table only: the method keeps reading its keys from flash
+                const APIMethodDescriptor& d = *registered.descriptor;
+                cachePolicy.keys.assign(d.cacheKeys, d.cacheKeys + d.cacheKeyCount);
+            }
+            if (registered.coalesceWindow && registered.type != APIMethodType::EVT) {
+                Serial.printf("APISERVER: Coalescence ignorée pour %s (événements uniquement)\n", path.c_str());
+                registered.coalesceWindow = 0;
+            }
+            if (registered.delta && registered.type != APIMethodType::EVT) {
+                Serial.printf("APISERVER: Delta ignoré pour %s (événements uniquement)\n", path.c_str());
+                registered.delta = false;
+            }
 
-        // Add protocol exclusions
-        if (!method.exclusions.empty()) {
-            for (const auto& excl : method.exclusions) {
-                _excludedPathsByProtocol[excl].push_back(path);
+            registry.methods[path] = std::move(shared);
+
+            // Late registration (after begin): rebuild the route table
+            if (registry.routes.isBuilt()) {
+                registry.buildRoutes();
             }
-        }
+
+            // Add the route to module metadata
+            auto it = registry.modules.find(module);
+            if (it != registry.modules.end()) {
+                it->second.routes.push_back(path);
+            }
+        });
+        _cache.configure(path, cachePolicy.enabled, cachePolicy.keys);
+        invalidateDocs();
     }
 
     /**
-     * @brief Execute a method
-     * @param protocol The protocol of the client (used to check if the method is excluded)
+     * @brief Register a method described by a flash-resident descriptor
+     * @brief The descriptor is referenced, not copied: declare it static constexpr.
+     * @param module The name of the module
      * @param path The path of the method
-     * @param args The arguments of the method
-     * @param response The response of the method
-     * @return True if the method has been executed, false otherwise
+     * @param descriptor The method schema (static storage)
+     * @param handler The function to execute when the method is called
+     */
+    void registerMethod(const String& module, const String& path, const APIMethodDescriptor& descriptor,
+                        APIMethod::Handler handler) {
+        APIMethod method;
+        method.type = descriptor.type;
+        method.handler = handler;
+        method.descriptor = &descriptor;
+        method.hidden = descriptor.hidden;
+        registerMethod(module, path, method);
+    }
+
+    /**
+     * @brief Register a method described by a flash-resident descriptor, with a deferred handler
+     */
+    void registerMethod(const String& module, const String& path, const APIMethodDescriptor& descriptor,
+                        APIMethod::DeferredHandler deferred) {
+        APIMethod method;
+        method.type = descriptor.type;
+        method.deferred = deferred;
+        method.descriptor = &descriptor;
+        method.hidden = descriptor.hidden;
+        registerMethod(module, path, method);
+    }
+
+    /**
+     * @brief Register an event described by a flash-resident descriptor (no handler)
+     */
+    void registerMethod(const String& module, const String& path, const APIMethodDescriptor& descriptor) {
+        registerMethod(module, path, descriptor, APIMethod::Handler([](const JsonObject*, JsonObject&) { return false; }));
+    }
+
+    /**
+     * @brief Register a method described by a flash-resident descriptor, with a response writer
+     */
+    void registerMethod(const String& module, const String& path, const APIMethodDescriptor& descriptor,
+                        APIMethod::WriterHandler writer) {
+        APIMethod method;
+        method.type = descriptor.type;
+        method.writer = writer;
+        method.descriptor = &descriptor;
+        method.hidden = descriptor.hidden;
+        registerMethod(module, path, method);
+    }
+
+    /**
+     * @brief Execute a method
+     * @param protocolId The protocol ID of the client (used to check if the method is excluded)
+     * @param path The path of the method
+     * @param args The arguments of the method
+     * @param response The response of the method
+     * @return True if the method has been executed, false otherwise
+     */
+    bool executeMethod(uint8_t protocolId, const String& path, const JsonObject* args, JsonObject& response) const {
+        RegistryReader registry = readRegistry();   // Keeps the method alive during the call
+        const APIMethod* method = findCalledMethod(*registry, protocolId, path);
+        if (!method || !validateCall(*method, protocolId, args)) {
+            return false;
+        }
+        if (method->deferred) {
+            Serial.printf("APISERVER: %s est asynchrone, utiliser executeMethodAsync\n", path.c_str());
+            recordCall(*method, protocolId, false);
+            return false;
+        }
+        String body;    // Only filled if needed (writer, cache, callers sharing the call)
+        bool success = runMethod(*method, path, args, &response, body);
+        recordCall(*method, protocolId, success);
+        return success;
+    }
+
+    /**
+     * @brief Execute a method, serializing the response as JSON text
+     * @brief Methods with a writer stream straight into output (no JsonDocument),
+     * @brief the others fill a JsonDocument which is then serialized.
+     * @param protocolId The protocol ID of the client (used to check if the method is excluded)
+     * @param path The path of the method
+     * @param args The arguments of the method
+     * @param output The serialized response (appended)
+     * @return True if the method has been executed, false otherwise
+     */
+    bool executeMethod(uint8_t protocolId, const String& path, const JsonObject* args, String& output) const {
+        RegistryReader registry = readRegistry();
+        const APIMethod* method = findCalledMethod(*registry, protocolId, path);
+        if (!method || !validateCall(*method, protocolId, args)) {
+            return false;
+        }
+        if (method->deferred) {
+            recordCall(*method, protocolId, false);
+            return false;   // Response not available synchronously (see executeMethodAsync)
+        }
+        bool success;
+        if (output.isEmpty()) {
+            success = runMethod(*method, path, args, nullptr, output);
+        } else {
+            String body;
+            success = runMethod(*method, path, args, nullptr, body);
+            if (success) {
+                output += body;
+            }
+        }
+        recordCall(*method, protocolId, success);
+        return success;
+    }
+
+    /**
+     * @brief Get the cached response of a GET method, without calling its handler
+     * @brief Lets endpoints answer a cache hit from the transport task (e.g. in worker mode).
+     * @param protocolId The protocol ID of the client (used to check if the method is excluded)
+     * @param path The path of the method
+     * @param output The cached response (appended)
+     * @return True if a valid response was cached (counted as a hit), false otherwise (not counted)
+     */
+    bool getCachedResponse(uint8_t protocolId, const String& path, String& output) const {
+        RegistryReader registry = readRegistry();
+        const APIMethod* method = findMethod(*registry, protocolId, path);
+        if (!method || !method->cache.enabled) {
+            return false;
+        }
+        return _cache.peek(path, method->cache.ttl, output);
+    }
+
+    /**
+     * @brief Drop the cached responses depending on a key (module state changed)
+     * @param key A method path (e.g. "wifi/config") or a key declared with APIMethodBuilder::cache
+     */
+    void invalidateCache(const String& key) {
+        _cache.invalidate(key);
+    }
+
+    /**
+     * @brief Get the cache counters of a method, or of all cached methods
+     * @param path The path of the method (empty = all methods)
+     */
+    APIResponseCache::Stats getCacheStats(const String& path = "") const {
+        return _cache.getStats(path);
+    }
+
+    /**
+     * @brief Get the number of GET calls served by an identical call already in progress
+     * @brief (handler not called again: synchronous, worker and deferred calls)
+     */
+    uint32_t getSharedCallCount() const {
+        return _syncFlights.joined() + _workerFlights.joined() + _deferredJoined.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the queue depth and wait time of the requests of a priority class
+     * @brief (deferred/batch requests waiting for poll(), plus requests waiting for the worker)
+     */
+    APIQueueStats getRequestQueueStats(APIPriority priority) const {
+        APIQueueStats stats = _asyncRequests.getStats(priority);
+        if (_worker) {
+            stats += _worker->getQueueStats(priority);
+        }
+        return stats;
+    }
+
+    /**
+     * @brief Get the queue depth and wait time of the events of a priority class, summed over
+     * @brief the endpoints (wait = broadcast -> sent). Read from the loop task.
+     */
+    APIQueueStats getEventQueueStats(APIPriority priority) const {
+        APIQueueStats stats;
+        RegistryReader registry = readRegistry();
+        for (APIEndpoint* endpoint : registry->endpoints) {
+            stats += endpoint->getEventQueueStats(priority);
+        }
+        return stats;
+    }
+
+    /**
+     * @brief Get the call counters and phase latencies of a method
+     * @return nullptr if the method is not registered
+     */
+    std::shared_ptr<const APIMethodMetrics> getMethodMetrics(const String& path) const {
+        RegistryReader registry = readRegistry();
+        auto it = registry->methods.find(path);
+        return it != registry->methods.end() ? it->second->metrics : nullptr;
+    }
+
+    /**
+     * @brief Get the number of calls to unknown (or excluded) paths
+     */
+    uint32_t getUnknownCallCount() const {
+        return _unknownCalls.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Write the call metrics as JSON (served by sys/metrics)
+     * @param output Receives bucket bounds, protocols and one entry per method
+     * @param path Only this method (empty = all methods)
+     */
+    void getMetrics(JsonObject& output, const String& path = "") const {
+        RegistryReader registry = readRegistry();
+        output["uptime"] = millis();
+        output["unknown"] = getUnknownCallCount();
+        JsonArray bounds = output["bucketsUs"].to<JsonArray>();
+        for (uint32_t bound : APILatencyHistogram::BOUNDS_US) {
+            bounds.add(bound);
+        }
+        size_t protocolCount = metricsProtocolCount(*registry);
+        JsonObject methods = output["methods"].to<JsonObject>();
+        for (const auto& entry : registry->methods) {
+            if (!entry.second->metrics || (!path.isEmpty() && entry.first != path)) {
+                continue;
+            }
+            const APIMethodMetrics& metrics = *entry.second->metrics;
+            JsonObject method = methods[entry.first].to<JsonObject>();
+            method["calls"] = metrics.calls();
+            method["errors"] = metrics.errors();
+            method["cacheHits"] = metrics.cacheHits();
+            JsonObject protocols = method["protocols"].to<JsonObject>();
+            for (size_t i = 0; i < protocolCount; i++) {
+                if (metrics.calls(i)) {
+                    JsonObject protocol = protocols[registry->protocolNames[i]].to<JsonObject>();
+                    protocol["calls"] = metrics.calls(i);
+                    protocol["errors"] = metrics.errors(i);
+                }
+            }
+            for (size_t p = 0; p < API_PHASE_COUNT; p++) {
+                APIPhase phase = static_cast<APIPhase>(p);
+                const APILatencyHistogram& histogram = metrics.phase(phase);
+                JsonObject latency = method[apiPhaseToString(phase)].to<JsonObject>();
+                latency["count"] = histogram.count();
+                latency["totalUs"] = histogram.totalUs();
+                latency["maxUs"] = histogram.maxUs();
+                JsonArray buckets = latency["buckets"].to<JsonArray>();
+                for (size_t b = 0; b < APILatencyHistogram::BUCKET_COUNT; b++) {
+                    buckets.add(histogram.bucket(b));
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Write the call metrics in compact binary form (see APIMetricsEncoder for the layout)
+     * @param output Receives the encoded metrics (appended)
+     * @param path Only this method (empty = all methods)
+     */
+    void getMetricsBinary(std::vector<uint8_t>& output, const String& path = "") const {
+        RegistryReader registry = readRegistry();
+        APIMetricsEncoder encoder(output);
+        encoder.header(millis(), getUnknownCallCount());
+        size_t protocolCount = metricsProtocolCount(*registry);
+        encoder.protocols(registry->protocolNames, protocolCount);
+        size_t count = 0;
+        for (const auto& entry : registry->methods) {
+            if (entry.second->metrics && (path.isEmpty() || entry.first == path)) {
+                count++;
+            }
+        }
+        encoder.methodCount(count);
+        for (const auto& entry : registry->methods) {
+            if (entry.second->metrics && (path.isEmpty() || entry.first == path)) {
+                encoder.method(entry.first, *entry.second->metrics, protocolCount);
+            }
+        }
+    }
+
+    /**
+     * @brief Execute a method (protocol given by name)
+     * @param protocol The protocol of the client (used to check if the method is excluded)
+     * @param path The path of the method
+     * @param args The arguments of the method
+     * @param response The response of the method
+     * @return True if the method has been executed, false otherwise
      */
     bool executeMethod(const String& protocol, const String& path, const JsonObject* args, JsonObject& response) const {
-        // Check first if the method is excluded for this protocol
-        auto excludedPaths = _excludedPathsByProtocol.find(protocol);
-        if (excludedPaths != _excludedPathsByProtocol.end() && 
-            std::find(excludedPaths->second.begin(), excludedPaths->second.end(), path) != excludedPaths->second.end()) {
-            return false;  // Méthode exclue pour ce protocole
+        return executeMethod(getProtocolId(protocol), path, args, response);
+    }
+
+    /**
+     * @brief Execute a method whose response may be delivered later (deferred handlers)
+     * @brief Deferred methods: the handler is started from poll() (loop task, like the modules
+     * @brief completing it) and onComplete is called from poll() once the token is completed
+     * @brief (or with success = false after DEFERRED_TIMEOUT). Other methods: posted to the worker
+     * @brief task if there is one (onComplete called from poll()), otherwise executed here
+     * @brief (onComplete called before returning).
+     * @param protocolId The protocol ID of the client (used to check if the method is excluded)
+     * @param path The path of the method
+     * @param args The arguments of the method (copied if the call is not executed immediately)
+     * @param onComplete Function receiving the result
+     * @param request Optional token of the client request: cancel() it if the client goes away,
+     *                onComplete is then not called
+     * @return False if the method could not be started (onComplete is not called)
+     */
+    bool executeMethodAsync(uint8_t protocolId, const String& path, const JsonObject* args,
+                            const Completion& onComplete, const APIPendingResponse* request = nullptr) {
+        RegistryReader registry = readRegistry();
+        const APIMethod* method = findCalledMethod(*registry, protocolId, path);
+        if (!method) {
+            return false;
         }
 
-        auto it = _methods.find(path);
-        if (it != _methods.end()) {
-            if (!validateParams(it->second, args)) {
+        if (!method->deferred && hasWorker()) {
+            // Identical GET already waiting for the worker: share its result
+            Completion guarded = guardCompletion(onComplete, request);
+            String key = flightKey(*method, path, args);
+            if (!key.isEmpty() && _workerFlights.join(key, guarded)) {
+                return true;
+            }
+            bool posted = _worker->post(protocolId, path, args, [this, key, guarded](bool success, const JsonObject& response) {
+                guarded(success, response);
+                finishWorkerFlight(key, success, response);
+            }, method->priority);
+            if (!posted) {
+                Serial.printf("APISERVER: File du worker pleine, %s rejetée\n", path.c_str());
+                finishWorkerFlight(key, false, JsonObject());
                 return false;
             }
-            return it->second.handler(args, response);
+            return true;
         }
-        return false;
+
+        if (!method->deferred) {
+            // Identical GET running in another task: completed with its result, without waiting
+            String key = flightKey(*method, path, args);
+            if (!key.isEmpty() && _syncFlights.attach(key, sharedCompletion(*method, protocolId, guardCompletion(onComplete, request)))) {
+                return true;
+            }
+            JsonDocument doc;
+            JsonObject response = doc.to<JsonObject>();
+            bool success = executeMethod(protocolId, path, args, response);
+            onComplete(success, response);
+            return true;
+        }
+
+        if (!validateCall(*method, protocolId, args)) {
+            return false;
+        }
+        if (!postAsyncRequest(false, protocolId, path, args, onComplete, request, method->priority)) {
+            recordCall(*method, protocolId, false);
+            return false;
+        }
+        return true;    // Counted when completed (see processPendingResponses)
+    }
+
+    /**
+     * @brief Execute a list of calls and combine their responses (one round-trip for many methods)
+     * @brief The batch runs from poll(): each call is executed like executeMethodAsync (deferred
+     * @brief and worker calls included), onComplete receives {"results":[{path, success, response}]}
+     * @brief once every call is done, in the order of the calls. Methods requiring authentication
+     * @brief and nested batches are refused (success = false).
+     * @param protocolId The protocol ID of the client (excluded methods fail)
+     * @param args {"calls":[{"path":"wifi/status"}, {"path":"wifi/hostname","args":{...}}]}
+     * @param onComplete Function receiving the combined response
+     * @param request Optional token of the client request (see executeMethodAsync)
+     * @return False if the batch is malformed or cannot be queued (onComplete is not called)
+     */
+    bool executeBatch(uint8_t protocolId, const JsonObject* args, const Completion& onComplete,
+                      const APIPendingResponse* request = nullptr) {
+        if (!args) {
+            return false;
+        }
+        JsonArrayConst calls = (*args)["calls"];
+        if (calls.isNull() || calls.size() == 0 || calls.size() > MAX_BATCH_CALLS) {
+            return false;
+        }
+        for (JsonVariantConst call : calls) {
+            if (!call["path"].is<const char*>() || (!call["args"].isNull() && !call["args"].is<JsonObjectConst>())) {
+                return false;
+            }
+        }
+        return postAsyncRequest(true, protocolId, BATCH_PATH, args, onComplete, request, APIPriority::Interactive);
+    }
+
+    /**
+     * @brief Check if a method has a deferred handler (endpoints then use executeMethodAsync)
+     */
+    bool isDeferred(uint8_t protocolId, const String& path) const {
+        RegistryReader registry = readRegistry();
+        const APIMethod* method = findMethod(*registry, protocolId, path);
+        return method && method->deferred;
+    }
+
+    /**
+     * @brief Take the current registry snapshot (one atomic load, no lock)
+     * @brief Methods, modules and endpoints read through it stay valid while the reader exists,
+     * @brief even if a registration publishes a new snapshot meanwhile.
+     */
+    RegistryReader readRegistry() const {
+        return _registry.read();
+    }
+
+    /**
+     * @brief Find a method in a registry snapshot
+     * @param registry Snapshot held by the caller (see readRegistry)
+     * @param protocolId The protocol ID of the client (excluded methods are reported as not found)
+     * @param path The path of the method
+     * @return A pointer to the method (valid while the snapshot is held), or nullptr if not found or excluded
+     */
+    static const APIMethod* findMethod(const APIRegistry& registry, uint8_t protocolId, const String& path) {
+        const APIMethod* method = registry.lookup(path);
+        if (method && method->isExcludedFor(protocolId)) {
+            return nullptr;  // Méthode exclue pour ce protocole
+        }
+        return method;
+    }
+
+    /**
+     * @brief Find a registered method by path (no copy of the registry nor of the method)
+     * @param protocolId The protocol ID of the client (excluded methods are reported as not found)
+     * @param path The path of the method
+     * @return The method (kept alive by the reference, even if unregistered), or nullptr if
+     * not found or excluded for this protocol
+     */
+    APIMethodRef findMethod(uint8_t protocolId, const String& path) const {
+        RegistryReader registry = readRegistry();
+        auto it = registry->methods.find(path);
+        if (it == registry->methods.end() || it->second->isExcludedFor(protocolId)) {
+            return nullptr;
+        }
+        return it->second;
+    }
+
+    /**
+     * @brief Find a registered method by path (protocol given by name)
+     */
+    APIMethodRef findMethod(const String& protocol, const String& path) const {
+        return findMethod(getProtocolId(protocol), path);
+    }
+
+    /**
+     * @brief Get the ID of a protocol declared by an endpoint or used in an exclusion
+     * @param protocol The protocol name
+     * @return The protocol ID, or APIEndpoint::NO_PROTOCOL_ID if unknown
+     */
+    uint8_t getProtocolId(const String& protocol) const {
+        return readRegistry()->protocolId(protocol);
     }
 
     /**
@@ -421,21 +1606,101 @@ public:
      * @param data The data to broadcast
      */
     void broadcast(const String& event, const JsonObject& data) {
-        for (APIEndpoint* endpoint : _endpoints) {
+        // Exclusions of the event (unregistered events have none)
+        RegistryReader registry = readRegistry();
+        const APIMethod* eventMethod = registry->lookup(event);
+
+        // Coalesced event: keep the latest value, sent from poll() at the end of the window
+        if (eventMethod && eventMethod->coalesceWindow) {
+            std::lock_guard<std::mutex> lock(_eventMutex);
+            auto it = _coalescedEvents.find(event);
+            if (it == _coalescedEvents.end()) {
+                it = _coalescedEvents.emplace(event, CoalescedEvent()).first;
+                it->second.firstTime = millis();
+                it->second.window = eventMethod->coalesceWindow;
+                _scheduler.arm(_coalesceTimer, eventMethod->coalesceWindow);
+            } else {
+                _eventsMerged++;
+            }
+            it->second.data.set(data);
+            return;
+        }
+        deliverEvent(*registry, eventMethod, event, data);
+    }
+
+    /**
+     * @brief Check if a client listens to an event, on an endpoint where it is not excluded
+     * @brief Producers can skip building the payload of an event nobody receives.
+     * @param event The event path
+     */
+    bool hasSubscribers(const String& event) const {
+        RegistryReader registry = readRegistry();
+        const APIMethod* eventMethod = registry->lookup(event);
+        for (APIEndpoint* endpoint : registry->endpoints) {
             for (const auto& proto : endpoint->getProtocols()) {
-                // Check if the event is not excluded for this protocol
-                auto excludedPaths = _excludedPathsByProtocol.find(proto.name);
-                if (excludedPaths != _excludedPathsByProtocol.end() && 
-                    std::find(excludedPaths->second.begin(), excludedPaths->second.end(), event) != excludedPaths->second.end()) {
-                    continue;
-                }
-                // Check if the protocol supports events
-                if (proto.capabilities & APIEndpoint::EVT) {
-                    endpoint->pushEvent(event, data);
-                    continue;
+                if ((proto.capabilities & APIEndpoint::EVT) && !(eventMethod && eventMethod->isExcludedFor(proto.id))
+                    && endpoint->hasSubscribers(event)) {
+                    return true;
                 }
             }
         }
+        return false;
+    }
+
+    /**
+     * @brief Count a client subscription (called by the endpoints)
+     * @param event The event path, or APISubscriptions::ALL
+     */
+    void subscribe(const String& event) {
+        _subscriptions.add(event);
+    }
+
+    /**
+     * @brief Remove a client subscription (called by the endpoints, also on client disconnection)
+     * @param event The event path, or APISubscriptions::ALL
+     */
+    void unsubscribe(const String& event) {
+        _subscriptions.remove(event);
+    }
+
+    /**
+     * @brief Get the number of client subscriptions to an event, over all endpoints
+     * @param event The event path (APISubscriptions::ALL for the subscriptions to every event)
+     */
+    uint16_t getSubscriberCount(const String& event) const {
+        return _subscriptions.count(event);
+    }
+
+    /**
+     * @brief Get the latest value of an event, for a new client or one resynchronizing after a gap
+     * @param event The event path (registered EVT method)
+     * @return The latest event (to send with snapshot()), or nullptr if none was broadcast yet
+     */
+    APIEventRef getEventSnapshot(const String& event) const {
+        std::lock_guard<std::mutex> lock(_lastEventMutex);
+        auto it = _lastEvents.find(event);
+        return it == _lastEvents.end() ? nullptr : it->second.event;
+    }
+
+    /**
+     * @brief Get the latest value of every event broadcast so far (replayed to new clients)
+     */
+    std::vector<APIEventRef> getEventSnapshots() const {
+        std::lock_guard<std::mutex> lock(_lastEventMutex);
+        std::vector<APIEventRef> events;
+        events.reserve(_lastEvents.size());
+        for (const auto& [path, last] : _lastEvents) {
+            events.push_back(last.event);
+        }
+        return events;
+    }
+
+    /**
+     * @brief Get the number of broadcasts merged into a later one by coalescing
+     */
+    uint32_t getMergedEventCount() const {
+        std::lock_guard<std::mutex> lock(_eventMutex);
+        return _eventsMerged;
     }
 
     /**
@@ -448,7 +1713,7 @@ public:
         std::function<void(JsonObject&, const APIParam&)> addObjectParams = 
             [&addObjectParams](JsonObject& obj, const APIParam& param) {
                 if (param.type == "object" && !param.properties.empty()) {
-                    JsonObject nested = obj.createNestedObject(param.name);
+                    JsonObject nested = obj[param.name].to<JsonObject>();
                     for (const auto& prop : param.properties) {
                         if (prop.type == "object") {
                             addObjectParams(nested, prop);
@@ -471,16 +1736,18 @@ public:
                 }
             };
 
+        RegistryReader registry = readRegistry();
         int methodCount = 0; 
-        for (const auto& [path, method] : _methods) {
+        for (const auto& [path, entry] : registry->methods) {
+            const APIMethod& method = *entry;
             if (method.hidden) {
                 continue;  // Skip hidden methods
             }
             methodCount++;
-            JsonObject methodObj;
+            JsonObject methodObj = output.add<JsonObject>();
             methodObj["path"] = path;
             methodObj["type"] = apiMethodTypeToString(method.type);
-            methodObj["desc"] = method.description;
+            methodObj["desc"] = method.getDescription();
             
             // Add basic auth info if enabled
             if (method.auth.enabled) {
@@ -488,8 +1755,8 @@ public:
             }
             
             // Add supported protocols
-            JsonArray protocols = methodObj.createNestedArray("protocols");
-            for (const auto& endpoint : _endpoints) {
+            JsonArray protocols = methodObj["protocols"].to<JsonArray>();
+            for (const auto& endpoint : registry->endpoints) {
                 for (const auto& proto : endpoint->getProtocols()) {
                     uint8_t requiredCap;
                     switch (method.type) {
@@ -499,37 +1766,29 @@ public:
                     }
                     // Check if the protocol is supported and not excluded
                     bool isSupported = (proto.capabilities & requiredCap);
-                    bool isExcluded = false;
-                    for (const auto& excl : method.exclusions) {
-                        if (excl == proto.name) {
-                            isExcluded = true;
-                            break;
-                        }
-                    }
-                    if (isSupported && !isExcluded) {
+                    if (isSupported && !method.isExcludedFor(proto.id)) {
                         protocols.add(proto.name);
                     }
                 }
             }
 
             // Add parameters as object
-            if (!method.requestParams.empty()) {
-                JsonObject params = methodObj.createNestedObject("params");
-                for (const auto& param : method.requestParams) {
+            std::vector<APIParam> requestParams = method.getRequestParams();
+            if (!requestParams.empty()) {
+                JsonObject params = methodObj["params"].to<JsonObject>();
+                for (const auto& param : requestParams) {
                     addObjectParams(params, param);
                 }
             }
 
             // Add response parameters as object
-            if (!method.responseParams.empty()) {
-                JsonObject response = methodObj.createNestedObject("response");
-                for (const auto& param : method.responseParams) {
+            std::vector<APIParam> responseParams = method.getResponseParams();
+            if (!responseParams.empty()) {
+                JsonObject response = methodObj["response"].to<JsonObject>();
+                for (const auto& param : responseParams) {
                     addObjectParams(response, param);
                 }
             }
-
-            // Add the method to the output array
-            output.add(methodObj);
         }
         
         Serial.printf("APISERVER: Documentation générée pour %d méthodes\n", methodCount);
@@ -538,32 +1797,110 @@ public:
     }
 
     /**
-     * @brief Get the methods registered in the API server, optionally filtered by protocol
-     * @param protocol The protocol to filter by (optional : empty to get all methods)
-     * @return The methods (filtered by protocol if specified)
+     * @brief Get the compact JSON API documentation (same content as getAPIDoc)
+     * @brief Built on first request and cached until the registry changes.
+     * @return The serialized documentation (kept alive by the reference)
      */
-    const std::map<String, APIMethod> getMethods(const String& protocol = "") const {
-        if (protocol.isEmpty()) {
-            return _methods;  // Return all methods if no protocol is specified
-        }
+    DocRendering getAPIDocJson() {
+        return getDocRendering(DOC_FORMAT_JSON, [this](String& output) {
+            JsonDocument doc;
+            JsonArray methods = doc.to<JsonArray>();
+            getAPIDoc(methods);
+            serializeJson(doc, output);
+        });
+    }
+
+    /**
+     * @brief Get the ETag of a documentation rendering (hash of that rendering)
+     * @brief Each format has its own ETag: a change showing in one rendering only (e.g. the
+     * @brief OpenAPI metadata) does not leave the others answering 304 with a stale body.
+     * @param format Name of the rendering (the ETag is cached next to it)
+     * @param source Function returning the rendering to hash (e.g. getAPIDocJson)
+     * @return The quoted ETag, to compare with If-None-Match
+     */
+    DocRendering getDocETag(const String& format, const DocSource& source) {
+        return getDocRendering(format + DOC_ETAG_SUFFIX, [&source](String& output) {
+            DocRendering rendering = source();
+            const String& doc = *rendering;
+            uint32_t h = 2166136261u;   // FNV-1a
+            for (size_t i = 0; i < doc.length(); i++) {
+                h = (h ^ static_cast<uint8_t>(doc[i])) * 16777619u;
+            }
+            char etag[16];
+            snprintf(etag, sizeof(etag), "\"%08x\"", static_cast<unsigned>(h));
+            output = etag;
+        });
+    }
 
-        // Copy all methods and remove excluded ones
-        std::map<String, APIMethod> filteredMethods = _methods;
-        auto excludedPaths = _excludedPathsByProtocol.find(protocol);
-        if (excludedPaths != _excludedPathsByProtocol.end()) {
-            for (const auto& path : excludedPaths->second) {
-                filteredMethods.erase(path);
+    /**
+     * @brief Get a cached rendering of the API documentation
+     * @brief Endpoints use it for their own formats (e.g. serial tree, OpenAPI): the renderer
+     * @brief only runs once, the result is served as is until the registry changes.
+     * @brief Safe from any task: a registration drops the cached renderings, but the ones
+     * @brief already handed out stay valid while their reference is held (e.g. a response
+     * @brief being sent).
+     * @param format Name of the rendering (cache key)
+     * @param render Function filling the rendering (called on cache miss only)
+     * @return The rendering, shared with the cache
+     */
+    DocRendering getDocRendering(const String& format, const DocRenderer& render) {
+        uint32_t version;
+        {
+            std::lock_guard<std::mutex> lock(_docMutex);
+            auto it = _docRenderings.find(format);
+            if (it != _docRenderings.end()) {
+                return it->second;
             }
+            version = _registryVersion;
         }
-        return filteredMethods;
+
+        // Rendered without the lock: renderers may use other renderings (e.g. the ETag)
+        auto rendering = std::make_shared<String>();
+        {
+            RegistryReader registry = readRegistry();   // Renderers walk the registry (getMethods...)
+            render(*rendering);
+        }
+
+        std::lock_guard<std::mutex> lock(_docMutex);
+        if (_registryVersion != version) {
+            return rendering;   // Registry changed while rendering: not cached
+        }
+        return _docRenderings.emplace(format, rendering).first->second;  // First rendering kept
     }
 
     /**
-     * @brief Get the modules registered in the API server
+     * @brief Get the registry version (incremented at each registration)
+     */
+    uint32_t getRegistryVersion() const {
+        std::lock_guard<std::mutex> lock(_docMutex);
+        return _registryVersion;
+    }
+
+    /**
+     * @brief Get the methods registered in the API server, optionally filtered by protocol
+     * @brief The view holds the current snapshot until it is destroyed.
+     * @param protocol The protocol to filter by (optional : empty to get all methods)
+     * @return A view of the methods (filtered by protocol if specified)
+     */
+    APIMethodView getMethods(const String& protocol = "") const {
+        return getMethods(protocol.isEmpty() ? APIEndpoint::NO_PROTOCOL_ID : getProtocolId(protocol));
+    }
+
+    /**
+     * @brief Get the methods registered in the API server, filtered by protocol ID
+     * @param protocolId The protocol ID to filter by
+     * @return A view of the methods available for this protocol
+     */
+    APIMethodView getMethods(uint8_t protocolId) const {
+        return APIMethodView(readRegistry(), protocolId);
+    }
+
+    /**
+     * @brief Get the modules registered in the API server (copy of the current snapshot)
      * @return The modules
      */
-    const std::map<String, APIModuleInfo>& getModules() const {
-        return _modules;
+    std::map<String, APIModuleInfo> getModules() const {
+        return readRegistry()->modules;
     }
 
     /**
@@ -579,47 +1916,851 @@ public:
      * @param endpoint The endpoint to add
      */
     void addEndpoint(APIEndpoint* endpoint) {
-        _endpoints.push_back(endpoint);
+        updateRegistry([&](APIRegistry& registry) {
+            // Assign an ID to each protocol of the endpoint (shared with exclusions declared by name)
+            for (auto& proto : endpoint->_protocols) {
+                proto.id = internProtocol(registry, proto.name);
+            }
+            registry.endpoints.push_back(endpoint);
+        });
+        invalidateDocs();   // Protocols listed in the documentation changed
     }
 
     /**
-     * @brief Allows to access and modify the API metadata
+     * @brief Get the API metadata (read-only: change it with registerAPIInfo(), which
+     * @brief drops the cached documentation)
      * @return A reference to the APIInfo structure
      */
-    APIInfo& getAPIInfo() {
+    const APIInfo& getAPIInfo() const {
         return _apiInfo;
     }
 
 
 private:
     APIInfo _apiInfo;                              // Metadata about the API
-    std::map<String, APIModuleInfo> _modules;      // API module metadata (includes list of routes)
-    std::map<String, APIMethod> _methods;          // Registered methods by path
-    std::vector<APIEndpoint*> _endpoints;          // Objects implementing APIEndpoint
-    std::map<String, std::vector<String>> _excludedPathsByProtocol; // Excluded paths by protocol
+    APIScheduler _scheduler;                       // Deadlines of the components, sleep of the loop
+    APITimer _coalesceTimer;                       // End of the first coalescing window
+    APITimer _pendingTimer;                        // Next check of the deferred requests in progress
+    APITracer _tracer;                             // Request/event traces (off by default)
+    APISnapshot<APIRegistry> _registry;            // Methods, modules, endpoints & protocols (RCU snapshot)
+    std::atomic<bool> _started{false};             // begin() called: registrations publish a new snapshot
+    std::map<String, DocRendering> _docRenderings; // Cached documentation renderings, by format
+    uint32_t _registryVersion = 0;                 // Incremented at each registration
+    mutable std::mutex _docMutex;                  // Renderings are read from the transport tasks
+    mutable APIResponseCache _cache;               // Serialized GET responses (filled by const executeMethod)
+    mutable APISingleFlight<String> _syncFlights;  // GET calls running synchronously, by key
+    APISingleFlight<JsonObject> _workerFlights;    // GET calls posted to the worker, by key
+    std::atomic<uint32_t> _deferredJoined{0};      // Deferred calls sharing another one (counted from poll())
+    mutable std::atomic<uint32_t> _unknownCalls{0}; // Calls to unknown or excluded paths (metrics)
+
+    // Event broadcast during its coalescing window (latest value)
+    struct CoalescedEvent {
+        JsonDocument data;
+        unsigned long firstTime = 0;                // First broadcast of the window
+        uint32_t window = 0;
+    };
+
+    std::map<String, CoalescedEvent> _coalescedEvents;  // Waiting for the end of their window, by event
+    uint32_t _eventsMerged = 0;                    // Broadcasts replaced by a later value
+    APISubscriptions _subscriptions;               // Client subscriptions, reported by the endpoints
+    mutable std::mutex _eventMutex;                // Events can be broadcast from handlers (any task)
+
+    // Latest value of an event: replayed to new clients, base of the next patch of delta events
+    struct LastEvent {
+        APIEventRef event;
+        uint32_t seq = 0;                           // Delta events only
+    };
+
+    std::map<String, LastEvent> _lastEvents;       // Registered events broadcast so far, by event
+    mutable std::mutex _lastEventMutex;            // Held while an event is built and queued (sequence order)
+
+    // Deferred or batch request received by an endpoint, started from poll()
+    struct AsyncRequest {
+        bool batch = false;
+        uint8_t protocolId = 0;
+        String path;
+        JsonDocument args;
+        bool hasArgs = false;
+        Completion onComplete;
+        APIPendingResponse client;                  // Cancelled by the endpoint if the client goes away
+        APITrace trace;                             // Trace of the endpoint request, continued from poll()
+    };
+
+    struct PendingClient {
+        APIPendingResponse client;
+        Completion onComplete;
+        uint8_t protocolId = 0;                     // Call counted in the method metrics when completed
+        APITrace trace;
+    };
+
+    struct PendingResponse {
+        APIPendingResponse token;                   // Returned by the deferred handler
+        std::vector<PendingClient> clients;         // Requests sharing the call (identical GETs)
+        String key;                                 // Single-flight key (GET only, empty otherwise)
+        unsigned long startTime;
+        unsigned long startMicros = 0;              // Handler phase of the metrics (start -> completion)
+        std::vector<String> invalidates;            // Cache keys of the method, dropped on success
+        std::shared_ptr<APIMethodMetrics> metrics;
+
+        bool allCancelled() const {
+            for (const auto& c : clients) {
+                if (!c.client.isCancelled()) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    APIPriorityMailbox<AsyncRequest, ASYNC_REQUEST_CAPACITY> _asyncRequests;   // Posted from any task, per priority class
+    std::vector<PendingResponse> _pendingResponses; // Deferred requests waiting for completion (loop task only)
+    APIWorker* _worker = nullptr;                   // Task running the handlers (optional)
+    size_t _pollRotation = 0;                       // First endpoint of the next budgeted poll (loop task only)
 
 
     /**
-     * @brief Validate the parameters of a method
-     * @param method The method called
-     * @param args The arguments of incoming request
-     * @return True if the required parameters are present, false otherwise
+     * @brief Wrap a completion so that it is dropped once the client request is cancelled
      */
-    bool validateParams(const APIMethod& method, const JsonObject* args) const {
-        if (!args && !method.requestParams.empty()) {
-            return false;  // No arguments while expected
+    static Completion guardCompletion(const Completion& onComplete, const APIPendingResponse* request) {
+        if (!request) {
+            return onComplete;
+        }
+        return [onComplete, client = *request](bool success, const JsonObject& response) {
+            if (!client.isCancelled()) {
+                onComplete(success, response);
+            }
+        };
+    }
+
+    /**
+     * @brief Completion of a call attached to a synchronous call running in another task
+     * @brief Called on that task with the serialized response, counted like the call it joined.
+     */
+    static APISingleFlight<String>::Waiter sharedCompletion(const APIMethod& method, uint8_t protocolId, Completion onComplete) {
+        return [metrics = method.metrics, protocolId, onComplete, trace = APITrace::current()](bool success, const String& body) {
+            APITrace::Scope scope(trace);
+            JsonDocument doc;
+            success = success && !deserializeJson(doc, body);
+            metrics->recordCall(protocolId, success);
+            if (!success) {
+                trace.fail();
+            }
+            onComplete(success, doc.as<JsonObject>());
+        };
+    }
+
+    /**
+     * @brief Hand the result of a worker call to the callers that joined it
+     */
+    void finishWorkerFlight(const String& key, bool success, const JsonObject& response) {
+        if (key.isEmpty()) {
+            return;
+        }
+        for (auto& waiter : _workerFlights.finish(key)) {
+            waiter(success, response);
+        }
+    }
+
+    /**
+     * @brief Push an event to the endpoints supporting events, unless excluded for their protocol
+     * @brief or without subscriber. The payload is copied once into a shared APIEvent: endpoints
+     * @brief queue references to it and each wire format is serialized once for all of them.
+     * @brief Registered events are kept as their latest value (getEventSnapshot), even without
+     * @brief subscriber; unregistered ones are only built if an endpoint takes them.
+     */
+    void deliverEvent(const APIRegistry& registry, const APIMethod* eventMethod, const String& event, const JsonObject& data) {
+        APIEventRef shared;
+        APITrace trace = _tracer.start(event, APIEndpoint::NO_PROTOCOL_ID, true);
+        std::unique_lock<std::mutex> lastEventLock(_lastEventMutex, std::defer_lock);
+        if (eventMethod) {
+            lastEventLock.lock();
+            shared = recordEvent(*eventMethod, event, data, trace);
+        }
+        for (APIEndpoint* endpoint : registry.endpoints) {
+            if (!endpoint->hasSubscribers(event)) {
+                continue;
+            }
+            for (const auto& proto : endpoint->getProtocols()) {
+                // Check if the event is not excluded for this protocol
+                if (eventMethod && eventMethod->isExcludedFor(proto.id)) {
+                    continue;
+                }
+                // Check if the protocol supports events
+                if (proto.capabilities & APIEndpoint::EVT) {
+                    if (!shared) {
+                        auto built = std::make_shared<APIEvent>(event, data);
+                        built->setTrace(trace);
+                        shared = built;
+                    }
+                    endpoint->queueEvent(shared);
+                    continue;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Build the next event of a registered method and keep it as its latest value
+     * @brief (caller holds _lastEventMutex). Delta events: the first one carries the full value,
+     * @brief the next ones a merge-patch of the previous.
+     */
+    APIEventRef recordEvent(const APIMethod& method, const String& event, const JsonObject& data, const APITrace& trace) {
+        LastEvent& last = _lastEvents[event];
+        std::shared_ptr<APIEvent> built;
+        if (!method.delta) {
+            built = std::make_shared<APIEvent>(event, data, method.priority);
+        } else {
+            if (++last.seq == 0) {
+                last.seq = 1;       // 0 means "no sequence number"
+            }
+            if (last.event && last.event->seq()) {
+                JsonDocument patch;
+                APIMergePatch::diff(last.event->data(), data, patch.to<JsonObject>());
+                built = std::make_shared<APIEvent>(event, data, last.seq, &patch, method.priority);
+            } else {
+                built = std::make_shared<APIEvent>(event, data, last.seq, nullptr, method.priority);
+            }
+        }
+        built->setTrace(trace);
+        last.event = built;
+        return last.event;
+    }
+
+    /**
+     * @brief Send the coalesced events whose window is over (called from poll())
+     */
+    void flushCoalescedEvents() {
+        std::vector<std::pair<String, JsonDocument>> due;
+        {
+            std::lock_guard<std::mutex> lock(_eventMutex);
+            unsigned long now = millis();
+            for (auto it = _coalescedEvents.begin(); it != _coalescedEvents.end();) {
+                unsigned long elapsed = now - it->second.firstTime;
+                if (elapsed >= it->second.window) {
+                    due.emplace_back(it->first, std::move(it->second.data));
+                    it = _coalescedEvents.erase(it);
+                } else {
+                    _scheduler.arm(_coalesceTimer, it->second.window - elapsed);
+                    ++it;
+                }
+            }
+        }
+        if (due.empty()) {
+            return;
+        }
+        // Sent together: endpoints pack the events queued in the same poll into one frame
+        RegistryReader registry = readRegistry();
+        for (auto& [event, data] : due) {
+            deliverEvent(*registry, registry->lookup(event), event, data.as<JsonObject>());
+        }
+    }
+
+    /**
+     * @brief Poll the endpoints within a time budget, each one in its weighted slice (see poll)
+     */
+    void pollEndpoints(const std::vector<APIEndpoint*>& endpoints, unsigned long budgetUs) {
+        if (endpoints.empty()) {
+            return;
+        }
+        uint32_t weights = 0;
+        for (const APIEndpoint* endpoint : endpoints) {
+            weights += endpoint->_pollWeight;
         }
+        unsigned long start = micros();
+        size_t first = _pollRotation++ % endpoints.size();
+        for (size_t i = 0; i < endpoints.size(); i++) {
+            APIEndpoint* endpoint = endpoints[(first + i) % endpoints.size()];
+            unsigned long elapsed = micros() - start;
+            unsigned long remaining = elapsed < budgetUs ? budgetUs - elapsed : 0;
+            unsigned long slice = static_cast<unsigned long>(static_cast<uint64_t>(remaining) * endpoint->_pollWeight / weights);
+            weights -= endpoint->_pollWeight;
+
+            unsigned long pollStart = micros();
+            endpoint->_pollDeadline = pollStart + slice;
+            endpoint->_pollBudgeted = true;
+            endpoint->poll();
+            endpoint->_pollBudgeted = false;
+            uint32_t duration = static_cast<uint32_t>(micros() - pollStart);
+
+            APIEndpoint::PollStats& stats = endpoint->_pollStats;
+            stats.polls++;
+            stats.totalDurationUs += duration;
+            if (duration > stats.maxDurationUs) {
+                stats.maxDurationUs = duration;
+            }
+            if (duration > slice) {
+                stats.overruns++;
+                if (duration - slice > stats.maxOverrunUs) {
+                    stats.maxOverrunUs = duration - slice;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Queue a deferred or batch request for poll() (arguments copied, queued by priority class)
+     */
+    bool postAsyncRequest(bool batch, uint8_t protocolId, const String& path, const JsonObject* args,
+                          const Completion& onComplete, const APIPendingResponse* request, APIPriority priority) {
+        AsyncRequest async;
+        async.batch = batch;
+        async.protocolId = protocolId;
+        async.path = path;
         if (args) {
-            for (const auto& param : method.requestParams) {
-                if (param.required && !args->containsKey(param.name)) {
-                    return false;  // Missing required parameter
+            async.args.set(*args);
+            async.hasArgs = true;
+        }
+        async.onComplete = onComplete;
+        if (request) {
+            async.client = *request;
+        }
+        async.trace = APITrace::current();
+        if (!_asyncRequests.push(std::move(async), priority)) {
+            Serial.printf("APISERVER: Trop de requêtes asynchrones, %s rejetée\n", path.c_str());
+            return false;
+        }
+        _scheduler.wake();      // Started from poll()
+        return true;
+    }
+
+    /**
+     * @brief Start the deferred and batch requests posted by the endpoints (called from poll())
+     * @brief Taken in weighted priority order: control requests are started first under load.
+     */
+    void processAsyncRequests() {
+        AsyncRequest async;
+        while (_asyncRequests.pop(async)) {
+            if (async.client.isCancelled()) {
+                continue;
+            }
+            APITrace::Scope scope(async.trace);
+            JsonObject args = async.args.as<JsonObject>();
+            if (async.batch) {
+                runBatch(async.protocolId, args, guardCompletion(async.onComplete, &async.client));
+                continue;
+            }
+
+            RegistryReader registry = readRegistry();
+            const APIMethod* method = findMethod(*registry, async.protocolId, async.path);
+            if (!method || !method->deferred) {
+                Serial.printf("APISERVER: Impossible de lancer %s\n", async.path.c_str());
+                async.onComplete(false, JsonObject());
+                continue;
+            }
+
+            // Identical GET in progress (e.g. N clients asking for a scan): one handler call
+            String key = flightKey(*method, async.path, async.hasArgs ? &args : nullptr);
+            PendingResponse* inFlight = key.isEmpty() ? nullptr : findPendingResponse(key);
+            if (inFlight) {
+                inFlight->clients.push_back({async.client, std::move(async.onComplete), async.protocolId, async.trace});
+                _deferredJoined.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            if (_pendingResponses.size() >= MAX_PENDING_RESPONSES) {
+                Serial.printf("APISERVER: Impossible de lancer %s\n", async.path.c_str());
+                recordCall(*method, async.protocolId, false);
+                async.onComplete(false, JsonObject());
+                continue;
+            }
+            PendingResponse pending;
+            pending.startMicros = micros();
+            pending.token = method->deferred(async.hasArgs ? &args : nullptr);
+            pending.clients.push_back({async.client, std::move(async.onComplete), async.protocolId, async.trace});
+            pending.key = key;
+            pending.startTime = millis();
+            forEachInvalidation(*method, [&pending](const char* key) { pending.invalidates.push_back(key); });
+            pending.metrics = method->metrics;
+            _pendingResponses.push_back(std::move(pending));
+        }
+    }
+
+    /**
+     * @brief Run the calls of a batch, complete it when the last one is done (loop task)
+     */
+    void runBatch(uint8_t protocolId, JsonObject& args, const Completion& onComplete) {
+        struct BatchState {
+            JsonDocument doc;
+            size_t remaining;
+            Completion onComplete;
+        };
+        auto state = std::make_shared<BatchState>();
+        JsonArray results = state->doc["results"].to<JsonArray>();
+        JsonArray calls = args["calls"];
+        state->remaining = calls.size() + 1;    // +1: completed after all calls are started
+        state->onComplete = onComplete;
+
+        auto done = [state]() {
+            if (--state->remaining == 0) {
+                state->onComplete(true, state->doc.as<JsonObject>());
+            }
+        };
+
+        size_t index = 0;
+        for (JsonObject call : calls) {
+            String path = call["path"].as<const char*>();
+            JsonObject result = results.add<JsonObject>();
+            result["path"] = path;
+
+            APIMethodRef method = findMethod(protocolId, path);
+            bool allowed = method && !method->auth.enabled && path != BATCH_PATH;
+            JsonObject callArgs = call["args"];
+            bool started = allowed && executeMethodAsync(protocolId, path, callArgs.isNull() ? nullptr : &callArgs,
+                [state, index, done](bool success, const JsonObject& response) {
+                    JsonObject result = state->doc["results"][index];
+                    result["success"] = success;
+                    if (success) {
+                        result["response"].set(response);
+                    }
+                    done();
+                });
+            if (!started) {
+                result["success"] = false;
+                done();
+            }
+            index++;
+        }
+        done();
+    }
+
+    /**
+     * @brief Deliver the completed deferred responses (called from poll())
+     */
+    void processPendingResponses() {
+        if (_pendingResponses.empty()) {
+            return;
+        }
+
+        // Take the finished requests out first: callbacks may start new ones
+        std::vector<PendingResponse> finished;
+        unsigned long now = millis();
+        for (auto it = _pendingResponses.begin(); it != _pendingResponses.end();) {
+            if (it->allCancelled()) {
+                it->token.cancel();     // Clients gone: tell the module it can give up
+            } else if (!it->token.isDone() && now - it->startTime > DEFERRED_TIMEOUT) {
+                Serial.println("APISERVER: Timeout d'une réponse différée");
+                it->token.cancel();
+                it->token.complete(false);
+            }
+            if (it->token.isCancelled() || it->token.isDone()) {
+                finished.push_back(std::move(*it));
+                it = _pendingResponses.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        // Tokens can be completed from any task: checked again until all are finished
+        if (!_pendingResponses.empty()) {
+            _scheduler.arm(_pendingTimer, PENDING_CHECK_INTERVAL);
+        }
+
+        for (auto& pending : finished) {
+            bool success = pending.token.isDone() && pending.token.succeeded();
+            if (success) {
+                for (const auto& key : pending.invalidates) {
+                    _cache.invalidate(key);     // Even if the client is gone: the state changed
+                }
+            }
+            if (pending.token.isDone()) {
+                pending.metrics->recordPhase(APIPhase::Handler, static_cast<uint32_t>(micros() - pending.startMicros));
+            }
+            JsonObject response = success ? pending.token.response() : JsonObject();
+            for (auto& c : pending.clients) {
+                APITrace::Scope scope(c.trace);
+                c.trace.mark(APIStage::Handled);
+                pending.metrics->recordCall(c.protocolId, success);
+                if (!success) {
+                    c.trace.fail();
                 }
-                // We don't check the internal structure of objects
+                if (!c.client.isCancelled()) {
+                    c.onComplete(success, response);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Find a deferred GET in progress with the same key (loop task)
+     */
+    PendingResponse* findPendingResponse(const String& key) {
+        for (auto& pending : _pendingResponses) {
+            if (pending.key == key && !pending.token.isCancelled()) {
+                return &pending;
+            }
+        }
+        return nullptr;
+    }
+
+
+    /**
+     * @brief Register the built-in sys/metrics method (called by begin())
+     * @brief GET sys/metrics: JSON metrics; format=binary: APIMetricsEncoder layout in base64.
+     */
+    void registerMetricsMethod() {
+        if (readRegistry()->methods.count(METRICS_PATH)) {
+            return;     // begin() called again
+        }
+        registerModuleInfo(METRICS_MODULE, "Server diagnostics");
+        registerMethod(METRICS_MODULE, METRICS_PATH,
+            APIMethodBuilder(APIMethodType::GET, [this](const JsonObject* args, JsonObject& response) {
+                String path = args ? (*args)["path"] | "" : "";
+                String format = args ? (*args)["format"] | "" : "";
+                if (format == "binary") {
+                    std::vector<uint8_t> data;
+                    getMetricsBinary(data, path);
+                    response["format"] = "binary";
+                    response["data"] = APIMetricsEncoder::base64(data);
+                    return true;
+                }
+                getMetrics(response, path);
+                return true;
+            })
+            .desc("Call counts, errors and latency histograms of the API methods")
+            .param("path", APIParamType::String, false)     // Only this method (all if absent)
+            .param("format", APIParamType::String, false)   // "binary": packed records, base64 encoded
+            .response("uptime", APIParamType::Integer, false)
+            .response("unknown", APIParamType::Integer, false)
+            .response("methods", APIParamType::Object, false)
+            .response("data", APIParamType::String, false)
+            .priority(APIPriority::Telemetry)
+            .build()
+        );
+    }
+
+    /**
+     * @brief Register the built-in trace methods (called by begin())
+     * @brief GET sys/traces: last traces; SET sys/traces/config {"enabled":bool}: tracing on/off,
+     * @brief not reachable from the web endpoint (any client could slow every request down).
+     */
+    void registerTraceMethods() {
+        if (readRegistry()->methods.count(TRACES_PATH)) {
+            return;     // begin() called again
+        }
+        registerMethod(METRICS_MODULE, TRACES_PATH,
+            APIMethodBuilder(APIMethodType::GET, [this](const JsonObject*, JsonObject& response) {
+                response["enabled"] = _tracer.isEnabled();
+                JsonArray traces = response["traces"].to<JsonArray>();
+                getTraces(traces);
+                return true;
+            })
+            .desc("Last request and event traces, with the time of each stage (µs)")
+            .response("enabled", APIParamType::Boolean)
+            .response("traces", APIParamType::Object)
+            .priority(APIPriority::Telemetry)
+            .build()
+        );
+        registerMethod(METRICS_MODULE, TRACES_CONFIG_PATH,
+            APIMethodBuilder(APIMethodType::SET, [this](const JsonObject* args, JsonObject& response) {
+                bool enabled = (*args)["enabled"].as<bool>();
+                _tracer.setEnabled(enabled);
+                if (enabled) {
+                    _tracer.clear();
+                }
+                response["enabled"] = enabled;
+                return true;
+            })
+            .desc("Turn request and event tracing on or off (traces cleared when turned on)")
+            .param("enabled", APIParamType::Boolean)
+            .response("enabled", APIParamType::Boolean)
+            .excl({"http", "websocket"})    // Admin switch: local transports only (serial, MQTT)
+            .priority(APIPriority::Control)
+            .build()
+        );
+    }
+
+    /**
+     * @brief Protocols with their own counters in the metrics (see APIMethodMetrics::PROTOCOL_SLOTS)
+     */
+    static size_t metricsProtocolCount(const APIRegistry& registry) {
+        size_t count = registry.protocolNames.size();
+        return count < APIMethodMetrics::PROTOCOL_SLOTS ? count : APIMethodMetrics::PROTOCOL_SLOTS;
+    }
+
+    /**
+     * @brief Drop the cached documentation renderings (registry changed)
+     */
+    void invalidateDocs() {
+        std::lock_guard<std::mutex> lock(_docMutex);
+        _registryVersion++;
+        _docRenderings.clear();
+    }
+
+
+    /**
+     * @brief Get the ID of a protocol, assigning a new one if needed
+     * @param registry Registry being built (copy not published yet)
+     * @param protocol The protocol name
+     * @return The protocol ID, or APIEndpoint::NO_PROTOCOL_ID if too many protocols
+     */
+    static uint8_t internProtocol(APIRegistry& registry, const String& protocol) {
+        uint8_t id = registry.protocolId(protocol);
+        if (id != APIEndpoint::NO_PROTOCOL_ID) {
+            return id;
+        }
+        if (registry.protocolNames.size() >= APIEndpoint::MAX_PROTOCOLS) {
+            Serial.printf("APISERVER: Trop de protocoles, %s ignoré\n", protocol.c_str());
+            return APIEndpoint::NO_PROTOCOL_ID;
+        }
+        registry.protocolNames.push_back(protocol);
+        return static_cast<uint8_t>(registry.protocolNames.size() - 1);
+    }
+
+
+    /**
+     * @brief Compile the validation plan (and response layout for writers) of a registered method
+     * @param params Request schema (APIParam vector or descriptor list)
+     * @param response Response schema (APIParam vector or descriptor list)
+     */
+    template <typename Params, typename Response>
+    void compileMethod(const String& path, APIMethod& method, const Params& params, const Response& response) {
+        if (!method.validation.compile(params)) {
+            Serial.printf("APISERVER: Paramètres trop imbriqués pour %s, validation partielle\n", path.c_str());
+        }
+        if (method.writer && !method.responseLayout.compile(response)) {
+            Serial.printf("APISERVER: Réponse de %s non entièrement déclarée, writer inutilisable\n", path.c_str());
+        }
+        method.exclusionMask = 0;
+    }
+
+    /**
+     * @brief Apply a registration to the registry
+     * @brief Before begin() nothing reads the registry concurrently (endpoints and worker not
+     * @brief started): the registrations of the setup are applied in place, without copying the
+     * @brief registry each time, and begin() publishes the result once. Later registrations
+     * @brief publish a new snapshot (RCU).
+     */
+    template <typename F>
+    void updateRegistry(F&& modify) {
+        if (_started.load()) {
+            _registry.update(std::forward<F>(modify));
+        } else {
+            _registry.modifyInPlace(std::forward<F>(modify));
+        }
+    }
+
+    /**
+     * @brief Add a protocol to the exclusion mask of a method
+     */
+    static void excludeProtocol(APIRegistry& registry, APIMethod& method, const String& protocol) {
+        uint8_t id = internProtocol(registry, protocol);
+        if (id != APIEndpoint::NO_PROTOCOL_ID) {
+            method.exclusionMask |= (1u << id);
+        }
+    }
+
+
+
+    /**
+     * @brief Run the writer of a method over its compiled response layout
+     * @param method The method called
+     * @param args The arguments of incoming request
+     * @param output The serialized response (appended)
+     * @return True if the handler succeeded and the response matches the schema
+     */
+    bool writeResponse(const APIMethod& method, const JsonObject* args, String& output) const {
+        if (!method.responseLayout.isComplete()) {
+            return false;
+        }
+        APIResponseWriter writer(method.responseLayout, output);
+        bool success = method.writer(args, writer);
+        if (!writer.finish()) {
+            Serial.println("APISERVER: Réponse non conforme au schéma déclaré");
+            return false;
+        }
+        return success;
+    }
+
+    /**
+     * @brief Run a synchronous method (validated, not deferred)
+     * @brief Served from the cache if possible. Never waits for an identical GET running in another
+     * @brief task (the caller may be a transport task shared by other clients, or the one running
+     * @brief it): the handler then runs again. The asynchronous callers joining the call (see
+     * @brief executeMethodAsync) get its result.
+     * @param response Filled with the response (nullptr: body only)
+     * @param body Receives the serialized response (always if response is nullptr, otherwise
+     *             only when it was needed: writer, cache, shared call)
+     * @return True if the method succeeded
+     */
+    bool runMethod(const APIMethod& method, const String& path, const JsonObject* args,
+                   JsonObject* response, String& body) const {
+        uint32_t generation = 0;
+        bool cacheable = isCacheable(method, args);
+        if (cacheable && _cache.get(path, method.cache.ttl, body, generation)) {
+            method.metrics->recordCacheHit();
+            return !response || measure(method, APIPhase::Serialize, [&]() { return loadResponse(body, *response); });
+        }
+
+        String key = flightKey(method, path, args);
+        if (!key.isEmpty() && !_syncFlights.lead(key)) {
+            key = String();     // Identical call running elsewhere: not shared
+        }
+
+        bool success = callHandler(method, args, response, body);
+
+        // Hand the result to the callers that joined the call meanwhile
+        if (!key.isEmpty()) {
+            auto waiters = _syncFlights.finish(key);
+            if (success && response && body.isEmpty() && !waiters.empty()) {
+                measure(method, APIPhase::Serialize, [&]() { return serializeJson(*response, body); });
+            }
+            for (auto& waiter : waiters) {
+                waiter(success, body);
+            }
+        }
+
+        if (!success) {
+            return false;
+        }
+        if (cacheable) {
+            if (response && body.isEmpty()) {
+                measure(method, APIPhase::Serialize, [&]() { return serializeJson(*response, body); });
             }
+            _cache.put(path, body, generation);
         }
+        invalidateKeys(method);
         return true;
     }
 
+    /**
+     * @brief Call the handler or writer of a synchronous method (see runMethod)
+     * @brief A writer streams the response: its serialization is part of the handler phase.
+     */
+    bool callHandler(const APIMethod& method, const JsonObject* args, JsonObject* response, String& body) const {
+        if (method.writer) {
+            // Writer: response streamed, then loaded in the caller's document if any
+            return measure(method, APIPhase::Handler, [&]() { return writeResponse(method, args, body); })
+                && (!response || measure(method, APIPhase::Serialize, [&]() { return loadResponse(body, *response); }));
+        }
+        if (!method.handler) {
+            return false;
+        }
+        if (response) {
+            return measure(method, APIPhase::Handler, [&]() { return method.handler(args, *response); });
+        }
+        JsonDocument doc;
+        JsonObject obj = doc.to<JsonObject>();
+        if (!measure(method, APIPhase::Handler, [&]() { return method.handler(args, obj); })) {
+            return false;
+        }
+        measure(method, APIPhase::Serialize, [&]() { return serializeJson(doc, body); });
+        return true;
+    }
+
+    /**
+     * @brief Run a phase of a call, recording its duration in the metrics of the method
+     */
+    template <typename Phase>
+    static auto measure(const APIMethod& method, APIPhase phase, Phase&& run) -> decltype(run()) {
+        unsigned long start = micros();
+        auto result = run();
+        method.metrics->recordPhase(phase, static_cast<uint32_t>(micros() - start));
+        APITrace::markCurrent(traceStage(phase));
+        return result;
+    }
+
+    /**
+     * @brief Stage of the trace reached at the end of a measured phase
+     */
+    static constexpr APIStage traceStage(APIPhase phase) {
+        return phase == APIPhase::Validate ? APIStage::Validated
+             : phase == APIPhase::Handler ? APIStage::Handled : APIStage::Serialized;
+    }
+
+    /**
+     * @brief Count a finished call in the metrics of the method (and fail its trace on error)
+     */
+    static void recordCall(const APIMethod& method, uint8_t protocolId, bool success) {
+        method.metrics->recordCall(protocolId, success);
+        if (!success) {
+            APITrace::failCurrent();
+        }
+    }
+
+    /**
+     * @brief Look up a called method, counting the calls to unknown or excluded paths
+     */
+    const APIMethod* findCalledMethod(const APIRegistry& registry, uint8_t protocolId, const String& path) const {
+        const APIMethod* method = findMethod(registry, protocolId, path);
+        if (!method) {
+            _unknownCalls.fetch_add(1, std::memory_order_relaxed);
+            APITrace::failCurrent();
+        }
+        return method;
+    }
+
+    /**
+     * @brief Validate the arguments of a call (validate phase), counting a rejected call as an error
+     */
+    bool validateCall(const APIMethod& method, uint8_t protocolId, const JsonObject* args) const {
+        if (measure(method, APIPhase::Validate, [&]() { return validateParams(method, args); })) {
+            return true;
+        }
+        recordCall(method, protocolId, false);
+        return false;
+    }
+
+    /**
+     * @brief Key under which identical calls share one execution (GET methods only, empty otherwise)
+     */
+    static String flightKey(const APIMethod& method, const String& path, const JsonObject* args) {
+        if (method.type != APIMethodType::GET) {
+            return String();
+        }
+        return APISingleFlight<String>::key(path, args);
+    }
+
+    /**
+     * @brief Check if a call can be served from / stored in the response cache (no arguments)
+     */
+    static bool isCacheable(const APIMethod& method, const JsonObject* args) {
+        return method.cache.enabled && (!args || args->size() == 0);
+    }
+
+    /**
+     * @brief Drop the cached responses invalidated by a successful call
+     */
+    void invalidateKeys(const APIMethod& method) const {
+        forEachInvalidation(method, [this](const char* key) { _cache.invalidate(key); });
+    }
+
+    /**
+     * @brief Visit the cache keys invalidated by a method (from its descriptor if any)
+     */
+    template <typename F>
+    static void forEachInvalidation(const APIMethod& method, F&& visit) {
+        if (method.descriptor) {
+            for (size_t i = 0; i < method.descriptor->invalidationCount; i++) {
+                visit(method.descriptor->invalidations[i]);
+            }
+            return;
+        }
+        for (const auto& key : method.invalidates) {
+            visit(key.c_str());
+        }
+    }
+
+    /**
+     * @brief Load a serialized response in the caller's object
+     */
+    static bool loadResponse(const String& json, JsonObject& response) {
+        JsonDocument doc;
+        if (deserializeJson(doc, json)) {
+            return false;
+        }
+        return response.set(doc.as<JsonObjectConst>());
+    }
+
+    /**
+     * @brief Validate the parameters of a method against its compiled plan
+     * @brief Checks presence, type and limits of every parameter, nested objects included.
+     * @param method The method called
+     * @param args The arguments of incoming request
+     * @return True if the arguments match the method schema, false otherwise
+     */
+    bool validateParams(const APIMethod& method, const JsonObject* args) const {
+        return method.validation.validate(args);
+    }
+
 
 };
 
@@ -0,0 +1,114 @@
+#ifndef APISINGLEFLIGHT_H
+#define APISINGLEFLIGHT_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Table of the calls in flight, to share one execution between identical calls
+ * @brief The first caller of a key leads the call: it runs the handler then takes the callers
+ * @brief that joined meanwhile (finish) and hands them its result. Identical GET requests
+ * @brief arriving together (dashboards reconnecting, N clients asking for a scan) then cost
+ * @brief one handler execution. Usable from any task (short lock, never held while running).
+ * @tparam T Type of the shared result (serialized text, JSON object...)
+ */
+template <typename T>
+class APISingleFlight {
+public:
+    using Waiter = std::function<void(bool success, const T& result)>;
+
+    /**
+     * @brief Key of a call: path, plus the arguments in their serialized form
+     */
+    static String key(const String& path, const JsonObject* args) {
+        if (!args || args->size() == 0) {
+            return path;
+        }
+        String key = path;
+        key += '?';
+        serializeJson(*args, key);
+        return key;
+    }
+
+    /**
+     * @brief Join the call in flight for a key, or lead a new one
+     * @param waiter Called by the leader with the result (only if joined)
+     * @return True if joined, false if the caller leads the call (it must call finish)
+     */
+    bool join(const String& key, Waiter waiter) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _flights.find(key);
+        if (it == _flights.end()) {
+            _flights.emplace(key, std::vector<Waiter>());
+            return false;
+        }
+        it->second.push_back(std::move(waiter));
+        _joined.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Join the call in flight for a key, if any (never leads a new one)
+     * @param waiter Called by the leader with the result (only if joined)
+     * @return True if joined
+     */
+    bool attach(const String& key, Waiter waiter) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _flights.find(key);
+        if (it == _flights.end()) {
+            return false;
+        }
+        it->second.push_back(std::move(waiter));
+        _joined.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Lead a call for a key, unless one is already in flight (never joins it)
+     * @return True if the caller leads the call (it must call finish)
+     */
+    bool lead(const String& key) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _flights.emplace(key, std::vector<Waiter>()).second;
+    }
+
+    /**
+     * @brief Check if a call is in flight for a key
+     */
+    bool running(const String& key) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _flights.count(key) > 0;
+    }
+
+    /**
+     * @brief End a call (leader): later callers will lead a new one
+     * @return The callers that joined it, to call with the result
+     */
+    std::vector<Waiter> finish(const String& key) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::vector<Waiter> waiters;
+        auto it = _flights.find(key);
+        if (it != _flights.end()) {
+            waiters = std::move(it->second);
+            _flights.erase(it);
+        }
+        return waiters;
+    }
+
+    /**
+     * @brief Number of calls served by another caller's execution
+     */
+    uint32_t joined() const { return _joined.load(std::memory_order_relaxed); }
+
+private:
+    std::map<String, std::vector<Waiter>> _flights;     // Calls in flight, by key
+    std::atomic<uint32_t> _joined{0};
+    mutable std::mutex _mutex;
+};
+
+#endif // APISINGLEFLIGHT_H
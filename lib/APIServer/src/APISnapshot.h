@@ -0,0 +1,165 @@
+#ifndef APISNAPSHOT_H
+#define APISNAPSHOT_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Immutable value published with read-copy-update (RCU)
+ * @brief Readers take the current version with one atomic load and never lock: a Reader
+ * @brief keeps that version alive while it exists. Writers copy the current version, modify
+ * @brief the copy and swap it in; the previous version is retired, and deleted by reclaim()
+ * @brief once the readers that may hold it are gone (grace period, two reader epochs).
+ * @brief Writers are serialized but never wait for the readers: a task holding a Reader
+ * @brief (e.g. a request handler) can publish an update.
+ */
+template <typename T>
+class APISnapshot {
+public:
+    /**
+     * @brief Access to one version of the value (RAII, cheap, never blocks)
+     */
+    class Reader {
+    public:
+        explicit Reader(const APISnapshot& owner) {
+            uint32_t epoch = owner._epoch.load();
+            _counter = &owner._readers[epoch & 1];
+            _counter->fetch_add(1);
+            _value = owner._current.load();     // After the registration: a writer cannot free it now
+        }
+
+        Reader(Reader&& other) noexcept : _counter(other._counter), _value(other._value) {
+            other._counter = nullptr;
+        }
+
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+        Reader& operator=(Reader&&) = delete;
+
+        ~Reader() {
+            if (_counter) {
+                _counter->fetch_sub(1, std::memory_order_release);
+            }
+        }
+
+        const T* operator->() const { return _value; }
+        const T& operator*() const { return *_value; }
+
+    private:
+        std::atomic<uint32_t>* _counter;
+        const T* _value;
+    };
+
+    APISnapshot() : _current(new T()) {}
+
+    ~APISnapshot() {
+        delete _current.load();
+        for (const Retired& retired : _retired) {
+            delete retired.value;
+        }
+    }
+
+    APISnapshot(const APISnapshot&) = delete;
+    APISnapshot& operator=(const APISnapshot&) = delete;
+
+    /**
+     * @brief Take the current version (valid while the Reader exists)
+     */
+    Reader read() const {
+        return Reader(*this);
+    }
+
+    /**
+     * @brief Publish a modified copy of the current version (never blocks on the readers)
+     * @brief The previous version is retired: deleted right away if no reader is active,
+     * @brief otherwise by a later reclaim().
+     * @param modify Function modifying the copy (T&), before it becomes visible to readers
+     */
+    template <typename F>
+    void update(F&& modify) {
+        std::lock_guard<std::mutex> lock(_writeMutex);
+        T* next = new T(*_current.load());
+        modify(*next);
+        _retired.push_back({_current.exchange(next), 0});
+        _version.fetch_add(1, std::memory_order_relaxed);
+        reclaimRetired();
+    }
+
+    /**
+     * @brief Delete the retired versions no reader can still hold (never blocks)
+     * @brief Called periodically by the owner (APIServer::poll()): a version stays retired
+     * @brief while a reader that took it is alive.
+     * @return Number of versions still retired
+     */
+    size_t reclaim() {
+        std::lock_guard<std::mutex> lock(_writeMutex);
+        return reclaimRetired();
+    }
+
+    /**
+     * @brief Modify the current version in place (no copy, no grace period)
+     * @brief Only while no reader can exist concurrently, e.g. during the setup before the tasks
+     * @brief reading the value are started.
+     * @param modify Function modifying the current version (T&)
+     */
+    template <typename F>
+    void modifyInPlace(F&& modify) {
+        std::lock_guard<std::mutex> lock(_writeMutex);
+        modify(*_current.load());
+    }
+
+    /**
+     * @brief Number of versions published (0 = initial value)
+     */
+    uint32_t version() const { return _version.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<T*> _current;
+    std::atomic<uint32_t> _epoch{0};
+    mutable std::atomic<uint32_t> _readers[2] = {{0}, {0}};   // Readers registered in even/odd epochs
+    std::atomic<uint32_t> _version{0};
+    std::mutex _writeMutex;
+
+    struct Retired {
+        const T* value;
+        uint8_t drainedSlots;   // Reader slots seen empty since the version was replaced (bit per slot)
+    };
+    std::vector<Retired> _retired;   // Replaced versions waiting for their grace period (under _writeMutex)
+
+    /**
+     * @brief Advance the grace period of the retired versions, delete the ones it covers
+     * @brief A reader registers in the slot of the epoch it read, possibly stale, before
+     * @brief loading the version: a version is unreachable once both slots were seen empty
+     * @brief after it was replaced. The slot of the previous epoch is checked, then the
+     * @brief epoch moves so that new readers leave the other slot to drain.
+     * @return Number of versions still retired
+     */
+    size_t reclaimRetired() {
+        for (int phase = 0; phase < 2 && !_retired.empty(); phase++) {
+            uint32_t idle = (_epoch.load() + 1) & 1;
+            if (_readers[idle].load() != 0) {
+                break;      // Readers of that slot still running: next call
+            }
+            for (Retired& retired : _retired) {
+                retired.drainedSlots |= 1 << idle;
+            }
+            _epoch.fetch_add(1);
+        }
+
+        size_t kept = 0;
+        for (Retired& retired : _retired) {
+            if (retired.drainedSlots == 0x3) {
+                delete retired.value;
+            } else {
+                _retired[kept++] = retired;
+            }
+        }
+        _retired.resize(kept);
+        return kept;
+    }
+};
+
+#endif // APISNAPSHOT_H
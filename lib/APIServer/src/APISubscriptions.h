@@ -0,0 +1,74 @@
+#ifndef APISUBSCRIPTIONS_H
+#define APISUBSCRIPTIONS_H
+
+#include <Arduino.h>
+#include <map>
+#include <mutex>
+
+/**
+ * @brief Subscriber counts per event path ("*" = all events)
+ * @brief Kept by the APIServer for all clients, and by the endpoints for their own clients so
+ * @brief that broadcast skips those where nobody listens. Accessed from any task (short lock).
+ */
+class APISubscriptions {
+public:
+    static constexpr const char* ALL = "*";     // Subscription to every event
+
+    /**
+     * @brief Count a subscriber of an event
+     */
+    void add(const String& event) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _counts[event]++;
+        _total++;
+    }
+
+    /**
+     * @brief Remove a subscriber of an event
+     * @return False if the event had no subscriber
+     */
+    bool remove(const String& event) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _counts.find(event);
+        if (it == _counts.end()) {
+            return false;
+        }
+        if (--it->second == 0) {
+            _counts.erase(it);
+        }
+        _total--;
+        return true;
+    }
+
+    /**
+     * @brief Number of subscribers of an event (subscribers to ALL excluded)
+     */
+    uint16_t count(const String& event) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _counts.find(event);
+        return it == _counts.end() ? 0 : it->second;
+    }
+
+    /**
+     * @brief Check if a subscriber listens to an event (directly or through ALL)
+     */
+    bool matches(const String& event) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _counts.find(event) != _counts.end() || _counts.find(ALL) != _counts.end();
+    }
+
+    /**
+     * @brief Check if no subscription was declared
+     */
+    bool empty() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _total == 0;
+    }
+
+private:
+    std::map<String, uint16_t> _counts;         // Subscribers, by event path
+    uint32_t _total = 0;
+    mutable std::mutex _mutex;
+};
+
+#endif // APISUBSCRIPTIONS_H
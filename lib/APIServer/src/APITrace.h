@@ -0,0 +1,262 @@
+#ifndef APITRACE_H
+#define APITRACE_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Stage of the request/event pipeline timestamped by a trace
+ */
+enum class APIStage : uint8_t {
+    Received = 0,       // Request read by the endpoint (event: broadcast)
+    Parsed = 1,         // Request decoded (JSON, command line)
+    Validated = 2,      // Arguments checked (after the wait in the worker or deferred queue)
+    Handled = 3,        // Handler returned (deferred: token completed)
+    Serialized = 4,     // Response or event encoded for the wire
+    Queued = 5,         // Put in the send queue of the endpoint (events, serial responses)
+    Sent = 6            // Handed to the transport
+};
+
+static constexpr size_t API_STAGE_COUNT = 7;
+
+constexpr const char* apiStageToString(APIStage stage) {
+    switch (stage) {
+        case APIStage::Received: return "received";
+        case APIStage::Parsed: return "parsed";
+        case APIStage::Validated: return "validated";
+        case APIStage::Handled: return "handled";
+        case APIStage::Serialized: return "serialized";
+        case APIStage::Queued: return "queued";
+        case APIStage::Sent: return "sent";
+        default: return "unknown";
+    }
+}
+
+/**
+ * @brief Finished trace, as kept by the APITracer
+ */
+struct APITraceRecord {
+    uint32_t id = 0;
+    String path;                                // Method or event
+    uint8_t protocolId = 0xFF;                  // APIEndpoint::NO_PROTOCOL_ID for events
+    bool event = false;
+    bool success = true;
+    unsigned long start = 0;                    // micros() at the Received stage
+    uint8_t reached = 0;                        // Bit n = stage n timestamped
+    uint32_t offsets[API_STAGE_COUNT] = {};     // µs since start, by stage
+
+    bool hasStage(APIStage stage) const { return reached & (1u << static_cast<uint8_t>(stage)); }
+    uint32_t offset(APIStage stage) const { return offsets[static_cast<size_t>(stage)]; }
+};
+
+class APITracer;
+
+/**
+ * @brief Handle of the trace of one request or event (empty when tracing is off)
+ * @brief Copies share the same trace: the endpoint, the worker job and the completion each
+ * @brief hold one. The first timestamp of a stage is kept. A request trace is recorded when
+ * @brief its last handle is dropped; an event trace when finish() is called (first send),
+ * @brief since the latest event is kept for replay long after it was sent.
+ * @brief The trace of the call running on a task is reachable through a Scope, so the
+ * @brief APIServer stamps validation, handler and serialization without extra parameters.
+ */
+class APITrace {
+public:
+    APITrace() = default;
+
+    explicit operator bool() const { return static_cast<bool>(_context); }
+
+    void mark(APIStage stage) const {
+        if (_context) {
+            _context->mark(stage);
+        }
+    }
+
+    // The request failed (recorded with success = false)
+    void fail() const {
+        if (_context) {
+            _context->failed.store(true, std::memory_order_release);
+        }
+    }
+
+    // Record the trace now (later stages are ignored)
+    void finish() const {
+        if (_context) {
+            _context->finish();
+        }
+    }
+
+    class Scope;
+
+    // Trace of the call running on this task (empty if none)
+    static APITrace current() {
+        const APITrace* trace = currentSlot();
+        return trace ? *trace : APITrace();
+    }
+
+    static void markCurrent(APIStage stage) {
+        const APITrace* trace = currentSlot();
+        if (trace) {
+            trace->mark(stage);
+        }
+    }
+
+    static void failCurrent() {
+        const APITrace* trace = currentSlot();
+        if (trace) {
+            trace->fail();
+        }
+    }
+
+private:
+    friend class APITracer;
+    friend class Scope;
+
+    struct Context {
+        APITraceRecord record;                          // Offsets and stages filled by finish()
+        APITracer* tracer = nullptr;
+        std::atomic<uint8_t> claimed{0};                // Stages being timestamped (first mark wins)
+        std::atomic<uint8_t> reached{0};                // Stages whose offset is written
+        std::atomic<uint32_t> offsets[API_STAGE_COUNT] = {};
+        std::atomic<bool> failed{false};
+        std::atomic<bool> finished{false};
+
+        ~Context() {
+            if (!record.event) {
+                finish();
+            }
+        }
+
+        // Marks from several tasks: the offset is written before its stage is published (release),
+        // so finish() reads only complete offsets; marks after finish() are dropped
+        void mark(APIStage stage) {
+            uint8_t bit = 1u << static_cast<uint8_t>(stage);
+            if (finished.load(std::memory_order_acquire) || (claimed.fetch_or(bit, std::memory_order_relaxed) & bit)) {
+                return;
+            }
+            offsets[static_cast<size_t>(stage)].store(static_cast<uint32_t>(micros() - record.start), std::memory_order_relaxed);
+            reached.fetch_or(bit, std::memory_order_release);
+        }
+
+        void finish();
+    };
+
+    std::shared_ptr<Context> _context;
+
+    static const APITrace*& currentSlot() {
+        static thread_local const APITrace* current = nullptr;
+        return current;
+    }
+};
+
+/**
+ * @brief Makes a trace the current one of the task until the end of the scope
+ */
+class APITrace::Scope {
+public:
+    explicit Scope(const APITrace& trace) : _trace(trace), _previous(currentSlot()) {
+        currentSlot() = &_trace;
+    }
+    ~Scope() { currentSlot() = _previous; }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    APITrace _trace;
+    const APITrace* _previous;
+};
+
+/**
+ * @brief Starts the traces and keeps the last finished ones in a ring buffer
+ * @brief Off by default: start() then returns an empty handle and every stamp is a null check.
+ */
+class APITracer {
+public:
+    static constexpr size_t CAPACITY = 16;     // Finished traces kept (oldest overwritten)
+
+    void setEnabled(bool enabled) { _enabled.store(enabled); }
+    bool isEnabled() const { return _enabled.load(); }
+
+    /**
+     * @brief Start the trace of a request or event (Received stage)
+     * @param receivedAt micros() when the request was read, if before this call (0 = now)
+     * @return Empty handle if tracing is off
+     */
+    APITrace start(const String& path, uint8_t protocolId, bool event = false, unsigned long receivedAt = 0) {
+        APITrace trace;
+        if (!_enabled.load(std::memory_order_relaxed)) {
+            return trace;
+        }
+        trace._context = std::make_shared<APITrace::Context>();
+        APITraceRecord& record = trace._context->record;
+        record.id = _nextId.fetch_add(1, std::memory_order_relaxed);
+        record.path = path;
+        record.protocolId = protocolId;
+        record.event = event;
+        record.start = receivedAt ? receivedAt : micros();
+        trace._context->tracer = this;
+        trace._context->claimed.store(1u << static_cast<uint8_t>(APIStage::Received), std::memory_order_relaxed);
+        trace._context->reached.store(1u << static_cast<uint8_t>(APIStage::Received), std::memory_order_relaxed);
+        return trace;
+    }
+
+    /**
+     * @brief Get the finished traces, oldest first
+     */
+    std::vector<APITraceRecord> getTraces() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::vector<APITraceRecord> traces;
+        traces.reserve(_count);
+        for (size_t i = 0; i < _count; i++) {
+            traces.push_back(_records[(_next + CAPACITY - _count + i) % CAPACITY]);
+        }
+        return traces;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _count = 0;
+    }
+
+private:
+    friend struct APITrace::Context;
+
+    mutable std::mutex _mutex;                  // Traces finish in any task
+    APITraceRecord _records[CAPACITY];
+    size_t _next = 0;
+    size_t _count = 0;
+    std::atomic<uint32_t> _nextId{1};
+    std::atomic<bool> _enabled{false};
+
+    void store(const APITraceRecord& record) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _records[_next] = record;
+        _next = (_next + 1) % CAPACITY;
+        if (_count < CAPACITY) {
+            _count++;
+        }
+    }
+};
+
+inline void APITrace::Context::finish() {
+    if (finished.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    // Stages published after this load are dropped (marked while the trace was finishing)
+    record.reached = reached.load(std::memory_order_acquire);
+    for (size_t i = 0; i < API_STAGE_COUNT; i++) {
+        if (record.reached & (1u << i)) {
+            record.offsets[i] = offsets[i].load(std::memory_order_relaxed);
+        }
+    }
+    record.success = !failed.load(std::memory_order_acquire);
+    if (tracer) {
+        tracer->store(record);
+    }
+}
+
+#endif // APITRACE_H
@@ -0,0 +1,157 @@
+#ifndef APIVALIDATIONPLAN_H
+#define APIVALIDATIONPLAN_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <vector>
+
+/**
+ * @brief Request parameters validation program, compiled from an APIParam schema
+ * @brief The schema tree is flattened once (APIServer::registerMethod) into a list of
+ * @brief steps in depth-first order. Validating a request is a single pass over that
+ * @brief list: presence, type, limits and nested objects are checked without walking
+ * @brief the schema or comparing type names.
+ * @brief The schema can be APIParam vectors (builder) or APIParamList (flash descriptors):
+ * @brief keys are not copied, steps point to the names stored in the registered schema
+ * @brief (the registered method is shared by the registry snapshots, never copied).
+ */
+class APIValidationPlan {
+public:
+    static constexpr uint8_t MAX_DEPTH = 8;     // Max nesting of object parameters
+
+    /**
+     * @brief Compile the validation plan from request parameters
+     * @param params Request parameters of the method (must outlive the plan)
+     * @return False if the schema is too deep (plan left empty: presence of args only)
+     */
+    template <typename Params>
+    bool compile(const Params& params) {
+        _steps.clear();
+        _expectsArgs = false;
+        for (const auto& param : params) {
+            _expectsArgs = _expectsArgs || param.required;   // Only optional params: a call without args is valid
+        }
+        if (!compileLevel(params, 0)) {
+            _steps.clear();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Validate the arguments of a request
+     * @param args The arguments of the request (nullptr if none)
+     * @return True if the arguments match the schema, false otherwise
+     */
+    bool validate(const JsonObject* args) const {
+        if (!args) {
+            return !_expectsArgs;  // No arguments while a parameter is required
+        }
+
+        JsonObjectConst frames[MAX_DEPTH + 1];
+        frames[0] = *args;
+
+        for (size_t i = 0; i < _steps.size(); i++) {
+            const Step& step = _steps[i];
+            JsonVariantConst value = frames[step.depth][step.key];
+
+            if (value.isNull()) {
+                if (step.required) {
+                    return false;  // Missing required parameter
+                }
+                i += step.subtreeSize;  // Absent optional object: skip its properties
+                continue;
+            }
+
+            switch (step.check) {
+                case Check::Boolean:
+                    if (!value.is<bool>()) return false;
+                    break;
+                case Check::Integer:
+                    if (!value.is<long>()) return false;
+                    if (step.hasLimits && !inRange(value.as<float>(), step)) return false;
+                    break;
+                case Check::Number:
+                    if (!value.is<float>()) return false;
+                    if (step.hasLimits && !inRange(value.as<float>(), step)) return false;
+                    break;
+                case Check::String:
+                    if (!value.is<const char*>()) return false;
+                    if (step.hasLimits && !inRange(strlen(value.as<const char*>()), step)) return false;
+                    break;
+                case Check::Object:
+                    if (!value.is<JsonObjectConst>()) return false;
+                    frames[step.depth + 1] = value.as<JsonObjectConst>();
+                    break;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Number of compiled steps (one per parameter, nested ones included)
+     */
+    size_t size() const { return _steps.size(); }
+
+private:
+    enum class Check : uint8_t {
+        Boolean,
+        Integer,
+        Number,
+        String,
+        Object
+    };
+
+    struct Step {
+        const char* key;            // Parameter name (in the schema), looked up in the current object
+        Check check;                // Expected JSON type
+        uint8_t depth;              // Object the key belongs to (0 = request root)
+        bool required;
+        bool hasLimits;             // Value range (numbers) or length range (strings)
+        uint16_t subtreeSize;       // Number of steps of nested properties following this one
+        float min;
+        float max;
+    };
+
+    std::vector<Step> _steps;
+    bool _expectsArgs = false;
+
+    static bool inRange(float value, const Step& step) {
+        return value >= step.min && value <= step.max;
+    }
+
+    static const char* typeName(const String& type) { return type.c_str(); }
+
+    template <typename Type>
+    static const char* typeName(Type type) { return paramTypeToString(type); }
+
+    static const char* keyOf(const String& name) { return name.c_str(); }
+    static const char* keyOf(const char* name) { return name; }
+
+    static Check checkFromType(const String& type) {
+        if (type == "boolean") return Check::Boolean;
+        if (type == "integer") return Check::Integer;
+        if (type == "number") return Check::Number;
+        if (type == "object") return Check::Object;
+        return Check::String;
+    }
+
+    template <typename Params>
+    bool compileLevel(const Params& params, uint8_t depth) {
+        if (!params.empty() && depth >= MAX_DEPTH) {
+            return false;
+        }
+        for (const auto& param : params) {
+            size_t index = _steps.size();
+            _steps.push_back({keyOf(param.name), checkFromType(typeName(param.type)), depth, param.required,
+                              param.hasLimits, 0, param.min, param.max});
+            if (!compileLevel(param.properties, depth + 1)) {
+                return false;
+            }
+            _steps[index].subtreeSize = static_cast<uint16_t>(_steps.size() - index - 1);
+        }
+        return true;
+    }
+};
+
+#endif // APIVALIDATIONPLAN_H
@@ -0,0 +1,297 @@
+#ifndef APIWORKER_H
+#define APIWORKER_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <atomic>
+#include <functional>
+#include "APIMailbox.h"
+#include "APIPriorityMailbox.h"
+#include "APITrace.h"
+
+#if !defined(ARDUINO_ARCH_ESP32)
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+/**
+ * @brief Task executing the API handlers, decoupled from the transports
+ * @brief Endpoints post requests into a bounded lock-free mailbox (from the AsyncTCP task,
+ * @brief the loop task...), the worker task runs the handlers one at a time and posts the
+ * @brief results into a second mailbox. The results are handed back to the transports by
+ * @brief dispatchCompletions(), called from APIServer::poll() (loop task).
+ * @brief Requests are queued per priority class and taken with weighted fairness (see
+ * @brief APIPriorityMailbox): control requests do not wait behind a backlog of telemetry.
+ * @brief On ESP32 the worker is a FreeRTOS task pinned to a core, woken by task notifications.
+ * @brief On host it is a std::thread (same mailboxes, used by the benchmarks).
+ */
+class APIWorker {
+public:
+    using Completion = std::function<void(bool success, const JsonObject& response)>;
+    using Executor = std::function<bool(uint8_t protocolId, const String& path, const JsonObject* args, JsonObject& response)>;
+    using Notifier = std::function<void()>;
+
+    static constexpr size_t REQUEST_CAPACITY = 16;         // Requests waiting for the worker, per priority class
+    static constexpr size_t COMPLETION_CAPACITY = 16;      // Results waiting for dispatchCompletions()
+    static constexpr int DEFAULT_CORE = 1;                 // Same core as loop(), WiFi/TCP stack on core 0
+    static constexpr uint32_t DEFAULT_STACK_SIZE = 8192;
+    static constexpr unsigned DEFAULT_PRIORITY = 2;        // Above loop() (1): handlers run as soon as posted
+
+    struct Stats {
+        uint32_t posted = 0;            // Requests accepted
+        uint32_t rejected = 0;          // Requests refused (mailbox full)
+        uint32_t completed = 0;         // Results handed back to the transports
+        uint32_t maxLatencyUs = 0;      // Worst post -> completion delay
+    };
+
+    APIWorker(int core = DEFAULT_CORE, uint32_t stackSize = DEFAULT_STACK_SIZE, unsigned priority = DEFAULT_PRIORITY)
+        : _core(core), _stackSize(stackSize), _priority(priority) {}
+
+    ~APIWorker() { end(); }
+
+    APIWorker(const APIWorker&) = delete;
+    APIWorker& operator=(const APIWorker&) = delete;
+
+    /**
+     * @brief Set the function running a request (set by APIServer::setWorker)
+     */
+    void setExecutor(Executor executor) {
+        _executor = executor;
+    }
+
+    /**
+     * @brief Set the function called (worker task) when a result is ready (set by APIServer::setWorker)
+     */
+    void setResultNotifier(Notifier notifier) {
+        _notifier = notifier;
+    }
+
+    /**
+     * @brief Start the worker task
+     * @return True if the task is running
+     */
+    bool begin() {
+        if (_running.load()) {
+            return true;
+        }
+        _running.store(true);
+#if defined(ARDUINO_ARCH_ESP32)
+        if (xTaskCreatePinnedToCore(taskEntry, "apiworker", _stackSize, this, _priority, &_task, _core) != pdPASS) {
+            Serial.println("APIWORKER: Impossible de créer la tâche");
+            _running.store(false);
+            return false;
+        }
+#else
+        _thread = std::thread([this]() { run(); });
+#endif
+        Serial.println("APIWORKER: Tâche démarrée");
+        return true;
+    }
+
+    /**
+     * @brief Stop the worker task (requests still in the mailbox are dropped)
+     */
+    void end() {
+        if (!_running.exchange(false)) {
+            return;
+        }
+        wake();
+#if !defined(ARDUINO_ARCH_ESP32)
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+#endif
+    }
+
+    bool isRunning() const { return _running.load(); }
+
+    /**
+     * @brief Post a request (any task, never blocks)
+     * @param args Arguments, copied into the request (nullptr if none)
+     * @param onComplete Called from dispatchCompletions() with the result
+     * @param priority Class of the request (see APIMethodBuilder::priority)
+     * @return False if the mailbox of the class is full (onComplete is not called)
+     */
+    bool post(uint8_t protocolId, const String& path, const JsonObject* args, Completion onComplete,
+              APIPriority priority = APIPriority::Interactive) {
+        Job job;
+        job.protocolId = protocolId;
+        job.path = path;
+        if (args) {
+            job.args.set(*args);
+            job.hasArgs = true;
+        }
+        job.onComplete = std::move(onComplete);
+        job.postedAt = micros();
+        job.trace = APITrace::current();     // Continued by the worker task and the completion
+
+        if (!_requests.push(std::move(job), priority)) {
+            _rejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        _posted.fetch_add(1, std::memory_order_relaxed);
+        wake();
+        return true;
+    }
+
+    /**
+     * @brief Hand the results back to the transports (called from APIServer::poll)
+     * @param max Maximal number of results to dispatch (0 = all)
+     * @return Number of results dispatched
+     */
+    size_t dispatchCompletions(size_t max = 0) {
+        size_t count = 0;
+        Result result;
+        while ((max == 0 || count < max) && _completions.pop(result)) {
+            if (result.onComplete) {
+                APITrace::Scope scope(result.trace);
+                result.onComplete(result.success, result.response.as<JsonObject>());
+            }
+            result.trace = APITrace();
+            uint32_t latency = static_cast<uint32_t>(micros() - result.postedAt);
+            if (latency > _maxLatencyUs.load(std::memory_order_relaxed)) {
+                _maxLatencyUs.store(latency, std::memory_order_relaxed);
+            }
+            _completed.fetch_add(1, std::memory_order_relaxed);
+            count++;
+        }
+        return count;
+    }
+
+    /**
+     * @brief Requests waiting for the worker
+     */
+    size_t pendingRequests() const { return _requests.size(); }
+
+    Stats getStats() const {
+        Stats stats;
+        stats.posted = _posted.load(std::memory_order_relaxed);
+        stats.rejected = _rejected.load(std::memory_order_relaxed);
+        stats.completed = _completed.load(std::memory_order_relaxed);
+        stats.maxLatencyUs = _maxLatencyUs.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    /**
+     * @brief Queue depth and wait time of the requests of a priority class
+     */
+    APIQueueStats getQueueStats(APIPriority priority) const {
+        return _requests.getStats(priority);
+    }
+
+private:
+    struct Job {
+        uint8_t protocolId = 0;
+        String path;
+        JsonDocument args;
+        bool hasArgs = false;
+        Completion onComplete;
+        unsigned long postedAt = 0;     // micros()
+        APITrace trace;
+    };
+
+    struct Result {
+        Completion onComplete;
+        JsonDocument response;
+        bool success = false;
+        unsigned long postedAt = 0;
+        APITrace trace;
+    };
+
+    Executor _executor;
+    Notifier _notifier;
+    APIPriorityMailbox<Job, REQUEST_CAPACITY> _requests;
+    APIMailbox<Result, COMPLETION_CAPACITY> _completions;
+    std::atomic<bool> _running{false};
+
+    std::atomic<uint32_t> _posted{0};
+    std::atomic<uint32_t> _rejected{0};
+    std::atomic<uint32_t> _completed{0};
+    std::atomic<uint32_t> _maxLatencyUs{0};
+
+    int _core;
+    uint32_t _stackSize;
+    unsigned _priority;
+
+#if defined(ARDUINO_ARCH_ESP32)
+    TaskHandle_t _task = nullptr;
+
+    static void taskEntry(void* param) {
+        static_cast<APIWorker*>(param)->run();
+        vTaskDelete(nullptr);
+    }
+
+    void wake() {
+        if (_task) {
+            xTaskNotifyGive(_task);
+        }
+    }
+
+    void waitForWork() {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+#else
+    std::thread _thread;
+    std::mutex _wakeMutex;                  // Only taken to sleep/wake, never to post or take requests
+    std::condition_variable _wakeCondition;
+    std::atomic<bool> _sleeping{false};
+
+    void wake() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_sleeping.exchange(false)) {
+            { std::lock_guard<std::mutex> lock(_wakeMutex); }
+            _wakeCondition.notify_one();
+        }
+    }
+
+    void waitForWork() {
+        _sleeping.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!_requests.empty() || !_running.load()) {
+            _sleeping.store(false);     // Posted meanwhile
+            return;
+        }
+        std::unique_lock<std::mutex> lock(_wakeMutex);
+        _wakeCondition.wait(lock, [this]() { return !_sleeping.load(); });
+    }
+#endif
+
+    /**
+     * @brief Worker loop: run the posted requests, sleep when the mailbox is empty
+     */
+    void run() {
+        Job job;
+        while (_running.load()) {
+            if (!_requests.pop(job)) {
+                waitForWork();
+                continue;
+            }
+
+            Result result;
+            JsonObject response = result.response.to<JsonObject>();
+            JsonObject args = job.args.as<JsonObject>();
+            {
+                APITrace::Scope scope(job.trace);
+                result.success = _executor && _executor(job.protocolId, job.path, job.hasArgs ? &args : nullptr, response);
+            }
+            result.onComplete = std::move(job.onComplete);
+            result.postedAt = job.postedAt;
+            result.trace = std::move(job.trace);
+            job = Job();
+
+            // Results mailbox full: leave time to the loop task to dispatch them
+            while (!_completions.push(std::move(result))) {
+                if (!_running.load()) {
+                    return;
+                }
+                delay(1);
+            }
+            if (_notifier) {
+                _notifier();
+            }
+        }
+    }
+};
+
+#endif // APIWORKER_H
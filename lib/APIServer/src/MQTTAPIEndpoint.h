@@ -5,7 +5,6 @@
 #include "APIEndpoint.h"
 #include <PubSubClient.h>
 #include <ArduinoJson.h>
-#include <queue>
 
 class MQTTAPIEndpoint : public APIEndpoint {
 public:
@@ -14,7 +13,6 @@ public:
         , _mqtt(client)
         , _broker(broker)
         , _port(port)
-        , _lastUpdate(0)
         , _connected(false)
     {
         addProtocol("mqtt", GET | SET | EVT);
@@ -30,17 +28,20 @@ public:
     }
 
     void begin() override {
+        // PubSubClient buffer (256 bytes by default) sized for a full frame of packed events
+        if (_mqtt.getBufferSize() < FRAME_SIZE + FRAME_OVERHEAD) {
+            _mqtt.setBufferSize(FRAME_SIZE + FRAME_OVERHEAD);
+        }
         reconnect();
+        _apiServer.scheduler().every(_loopTimer, LOOP_INTERVAL);
     }
 
     void poll() override {
-        unsigned long now = millis();
-        
-        // Process MQTT connection
+        // Process MQTT connection (timer not armed: first attempt, or retry delay over)
         if (!_mqtt.connected()) {
-            if (now - _lastUpdate > RECONNECT_INTERVAL) {
+            if (!_reconnectTimer.isArmed()) {
                 reconnect();
-                _lastUpdate = now;
+                _apiServer.scheduler().schedule(_reconnectTimer, RECONNECT_INTERVAL);
             }
             return;
         }
@@ -48,43 +49,66 @@ public:
         // Process MQTT messages
         _mqtt.loop();
 
-        // Process outgoing events
-        if (now - _lastUpdate > EVENT_INTERVAL) {
+        // Process outgoing events (kept until connected)
+        if (_eventTimer.fired() || _eventBacklog) {
             processEventQueue();
-            _lastUpdate = now;
         }
     }
 
     void pushEvent(const String& event, const JsonObject& data) override {
-        StaticJsonDocument<512> doc;
-        JsonObject eventObj = doc.to<JsonObject>();
-        eventObj["event"] = event;
-        eventObj["data"] = data;
-        
-        String message;
-        serializeJson(doc, message);
-        
-        if (_eventQueue.size() >= QUEUE_SIZE) {
-            _eventQueue.pop();
-        }
-        _eventQueue.push(message);
+        queueEvent(std::make_shared<APIEvent>(event, data));
+    }
+
+    // Shared event: only the reference is queued, encoded once for all endpoints
+    void queueEvent(const APIEventRef& event) override {
+        event->trace().mark(APIStage::Queued);
+        _eventQueue.push(event);
+        _apiServer.scheduler().arm(_eventTimer, EVENT_INTERVAL);    // Events of the window sent together
     }
 
+    // Events are published for all clients until one declares a subscription
+    bool hasSubscribers(const String& event) const override {
+        return _subscriptions.empty() || _subscriptions.matches(event);
+    }
+
+    APIQueueStats getEventQueueStats(APIPriority priority) const override {
+        return _eventQueue.getStats(priority);
+    }
+
+    /**
+     * @brief Number of events dropped after being refused by the MQTT client (while connected)
+     */
+    uint32_t getDroppedEventCount() const { return _droppedEvents; }
+
 private:
+    static constexpr unsigned long RECONNECT_INTERVAL = 5000;  // 5s between reconnect attempts
+    static constexpr unsigned long EVENT_INTERVAL = 50;        // Events queued within 50ms are published together
+    static constexpr unsigned long LOOP_INTERVAL = 20;         // Incoming messages read at this interval (no notification from the client)
+    static constexpr size_t QUEUE_SIZE = 10;
+    static constexpr size_t FRAME_SIZE = 512;                  // Events queued together are packed up to this size
+    static constexpr uint8_t MAX_PUBLISH_ATTEMPTS = 3;         // Refusals of a frame before unpacking it, then of an event before dropping it
+    static constexpr size_t MQTT_HEADER_SIZE = 5;              // Fixed header of a PUBLISH packet (PubSubClient worst case)
+    static constexpr size_t PROTOCOL_MQTT = 0;                 // Index of the "mqtt" protocol
+
     PubSubClient _mqtt;
     const char* _broker;
     uint16_t _port;
-    unsigned long _lastUpdate;
+    APITimer _loopTimer;
+    APITimer _reconnectTimer;
+    APITimer _eventTimer;               // Armed by the first event to publish
     bool _connected;
-    std::queue<String> _eventQueue;
-    
-    static constexpr unsigned long RECONNECT_INTERVAL = 5000;  // 5s between reconnect attempts
-    static constexpr unsigned long EVENT_INTERVAL = 50;        // 50ms between event processing
-    static constexpr size_t QUEUE_SIZE = 10;
+    APIEventQueue<QUEUE_SIZE> _eventQueue;
+    std::vector<APIEventRef> _outbox;   // Events taken from the queue, being published (loop task)
+    bool _eventBacklog = false;         // Events left by a poll out of budget, or refused
+    uint8_t _publishFailures = 0;       // Refusals of the frame at the head of the outbox
+    bool _unpacked = false;             // Outbox sent one event per frame (a packed frame was refused)
+    uint32_t _droppedEvents = 0;
+    APISubscriptions _subscriptions;                           // Declared by the clients (SUBSCRIBE / UNSUBSCRIBE)
     
     // MQTT Topic structure
     static constexpr const char* API_TOPIC = "api/";          // api/<path>
     static constexpr const char* EVENTS_TOPIC = "api/events"; // api/events
+    static constexpr size_t FRAME_OVERHEAD = MQTT_HEADER_SIZE + 2 + std::char_traits<char>::length(EVENTS_TOPIC);  // Header, topic length, topic
 
     char _clientId[15]; // Sufficient size for "ESP32_" + 6 hex characters
 
@@ -99,6 +123,7 @@ private:
     }
 
     void handleMessage(char* topic, byte* payload, unsigned int length) {
+        unsigned long receivedAt = micros();    // Start of the trace if this is an API request
         String topicStr(topic);
         if (!topicStr.startsWith(API_TOPIC)) return;
         
@@ -114,27 +139,33 @@ private:
 
         // For a simple GET request
         if (message == "GET") {
-            StaticJsonDocument<512> responseDoc;
-            JsonObject response = responseDoc.to<JsonObject>();
-            
-            // If it's a request on the api topic, return the doc
+            // If it's a request on the api topic, return the (cached) doc
             if (path.length() == 0) {
-                response = _apiServer.getAPIDoc();
-            } else if (_apiServer.executeMethod(path, nullptr, response)) {
-                // Otherwise execute the method normally
-            } else {
-                StaticJsonDocument<64> errorDoc;
-                errorDoc["error"] = "Invalid request";
-                String errorStr;
-                serializeJson(errorDoc, errorStr);
-                _mqtt.publish(topic, errorStr.c_str());
+                _mqtt.publish(topic, _apiServer.getAPIDocJson()->c_str());
                 return;
             }
-            
-            // Publish response
-            String responseStr;
-            serializeJson(response, responseStr);
-            _mqtt.publish(topic, responseStr.c_str());
+
+            APITrace trace = _apiServer.tracer().start(path, protocolId(PROTOCOL_MQTT), false, receivedAt);
+            APITrace::Scope scope(trace);
+            trace.mark(APIStage::Parsed);
+
+            // Response published once available (immediately, or from APIServer::poll for deferred methods)
+            if (!_apiServer.executeMethodAsync(protocolId(PROTOCOL_MQTT), path, nullptr, responder(topicStr))) {
+                publishError(topic, "Invalid request");
+            }
+            return;
+        }
+
+        // Event subscription: api/<event> with SUBSCRIBE or UNSUBSCRIBE (the broker cannot tell
+        // the endpoint who listens to api/events, so clients declare it)
+        if (message == "SUBSCRIBE" || message == "UNSUBSCRIBE") {
+            handleSubscription(path, message == "SUBSCRIBE");
+            return;
+        }
+
+        // Delta event: full value requested after a sequence gap, published on api/events
+        if (message == "RESYNC") {
+            publishSnapshots(path);
             return;
         }
 
@@ -152,20 +183,17 @@ private:
                 return;
             }
 
-            // Execute method
-            StaticJsonDocument<512> responseDoc;
-            JsonObject response = responseDoc.to<JsonObject>();
-            
-            if (_apiServer.executeMethod(path, &requestDoc.as<JsonObject>(), response)) {
-                String responseStr;
-                serializeJson(response, responseStr);
-                _mqtt.publish(topic, responseStr.c_str());
-            } else {
-                StaticJsonDocument<64> errorDoc;
-                errorDoc["error"] = "Invalid request";
-                String errorStr;
-                serializeJson(errorDoc, errorStr);
-                _mqtt.publish(topic, errorStr.c_str());
+            APITrace trace = _apiServer.tracer().start(path, protocolId(PROTOCOL_MQTT), false, receivedAt);
+            APITrace::Scope scope(trace);
+            trace.mark(APIStage::Parsed);
+
+            // Execute method (or batch: api/_batch with {"calls":[...]})
+            JsonObject args = requestDoc.as<JsonObject>();
+            bool started = (path == APIServer::BATCH_PATH)
+                ? _apiServer.executeBatch(protocolId(PROTOCOL_MQTT), &args, responder(topicStr))
+                : _apiServer.executeMethodAsync(protocolId(PROTOCOL_MQTT), path, &args, responder(topicStr));
+            if (!started) {
+                publishError(topic, "Invalid request");
             }
             return;
         }
@@ -178,14 +206,104 @@ private:
         _mqtt.publish(topic, errorStr.c_str());
     }
 
+    void handleSubscription(const String& event, bool subscribe) {
+        if (!subscribe) {
+            if (_subscriptions.remove(event)) {
+                _apiServer.unsubscribe(event);
+            }
+            return;
+        }
+        APIServer::RegistryReader registry = _apiServer.readRegistry();
+        const APIMethod* method = APIServer::findMethod(*registry, protocolId(PROTOCOL_MQTT), event);
+        if (event != APISubscriptions::ALL && !(method && method->type == APIMethodType::EVT)) {
+            Serial.printf("MQTTAPI: Abonnement refusé à %s\n", event.c_str());
+            return;
+        }
+        _subscriptions.add(event);
+        _apiServer.subscribe(event);
+        publishSnapshots(event);    // New subscriber: latest value at once
+    }
+
+    // Publish the latest value of an event (or "*" = all) on api/events
+    void publishSnapshots(const String& event) {
+        std::vector<APIEventRef> events = (event == APISubscriptions::ALL)
+            ? _apiServer.getEventSnapshots()
+            : std::vector<APIEventRef>{_apiServer.getEventSnapshot(event)};
+        APIServer::RegistryReader registry = _apiServer.readRegistry();
+        for (const APIEventRef& snapshot : events) {
+            if (snapshot && APIServer::findMethod(*registry, protocolId(PROTOCOL_MQTT), snapshot->name())) {
+                _mqtt.publish(EVENTS_TOPIC, snapshot->snapshot().c_str());
+            }
+        }
+    }
+
+    // Completion publishing the method response (or an error) on the request topic
+    APIServer::Completion responder(const String& topic) {
+        return [this, topic](bool success, const JsonObject& response) {
+            if (!success) {
+                publishError(topic.c_str(), "Invalid request");
+                return;
+            }
+            String responseStr;
+            serializeJson(response, responseStr);
+            APITrace::markCurrent(APIStage::Serialized);
+            _mqtt.publish(topic.c_str(), responseStr.c_str());
+            APITrace::markCurrent(APIStage::Sent);
+        };
+    }
+
+    void publishError(const char* topic, const char* error) {
+        APITrace::failCurrent();
+        StaticJsonDocument<64> errorDoc;
+        errorDoc["error"] = error;
+        String errorStr;
+        serializeJson(errorDoc, errorStr);
+        _mqtt.publish(topic, errorStr.c_str());
+    }
+
+    // Largest frame the PubSubClient buffer holds (it may have refused a larger buffer)
+    size_t frameSize() {
+        size_t buffer = _mqtt.getBufferSize();
+        return buffer > FRAME_OVERHEAD ? std::min(FRAME_SIZE, buffer - FRAME_OVERHEAD) : 0;
+    }
+
     void processEventQueue() {
-        while (!_eventQueue.empty() && _mqtt.connected()) {
-            if (_mqtt.publish(EVENTS_TOPIC, _eventQueue.front().c_str())) {
-                _eventQueue.pop();
+        // One message for the events queued since the last poll
+        String buffer;
+        size_t count;
+        _eventBacklog = false;
+        if (_outbox.empty()) {
+            _eventQueue.take(_outbox);  // Published without the queue lock: broadcasts are not blocked
+            _unpacked = false;
+        }
+        while (!_outbox.empty() && _mqtt.connected()) {
+            // A refused packed frame is sent again one event at a time (size 0: no packing)
+            size_t maxSize = _unpacked ? 0 : frameSize();
+            if (!_mqtt.publish(EVENTS_TOPIC, packEvents(_outbox, maxSize, buffer, count).c_str())) {
+                if (!_mqtt.connected() || ++_publishFailures < MAX_PUBLISH_ATTEMPTS) {
+                    break;  // Kept for the next attempt (after reconnection if the link dropped)
+                }
+                _publishFailures = 0;
+                if (count > 1) {
+                    _unpacked = true;
+                    continue;
+                }
+                // Refused alone: dropped, so it does not block the later events
+                Serial.printf("MQTTAPI: Événement %s abandonné (refusé par le client MQTT)\n", _outbox.front()->name().c_str());
+                _outbox.front()->trace().fail();
+                _outbox.front()->trace().finish();
+                _droppedEvents++;
             } else {
-                break; // Stop if publish fails
+                _publishFailures = 0;
+                markEventsSent(_outbox, count);
+            }
+            _outbox.erase(_outbox.begin(), _outbox.begin() + count);
+            if (!_outbox.empty() && pollBudgetExpired()) {
+                _apiServer.scheduler().wake();  // Rest published at the next poll, without waiting for the interval
+                break;
             }
         }
+        _eventBacklog = !_outbox.empty();   // Retried at the next poll
     }
 };
 
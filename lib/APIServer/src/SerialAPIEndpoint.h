@@ -2,7 +2,6 @@
 #define SERIALAPIENDPOINT_H
 
 #include <ArduinoJson.h>
-#include <queue>
 #include "APIServer.h"
 #include "APIEndpoint.h"
 #include "SerialProxy.h"
@@ -15,7 +14,6 @@ public:
     SerialAPIEndpoint(APIServer& apiServer, Stream& serial = Serial) 
         : APIEndpoint(apiServer)
         , _serial(serial)
-        , _lastTxRx(0)
         , _apiBufferIndex(0)
     {
         // Declare supported protocols
@@ -23,17 +21,34 @@ public:
     }
 
     void begin() override {
+        _apiServer.scheduler().every(_pollTimer, POLL_INTERVAL);
     }
 
     void poll() override {
         processStateMachine();      // Machine à états unique qui gère tout
+        if (hasWorkNow()) {
+            _apiServer.scheduler().wake();
+        }
     }
 
     void pushEvent(const String& event, const JsonObject& data) override {
-        if (_eventQueue.size() >= QUEUE_SIZE) {
-            _eventQueue.pop();
-        }
-        _eventQueue.push(SerialAPIFormatter::formatEvent(event, data));
+        queueEvent(std::make_shared<APIEvent>(event, data));
+    }
+
+    // Shared event: only the reference is queued, formatted once when first sent
+    void queueEvent(const APIEventRef& event) override {
+        event->trace().mark(APIStage::Queued);
+        _eventQueue.push(event);
+        _apiServer.scheduler().wake();
+    }
+
+    // Every event is sent until a subscription is declared (SUB / UNSUB commands)
+    bool hasSubscribers(const String& event) const override {
+        return _subscriptions.empty() || _subscriptions.matches(event);
+    }
+
+    APIQueueStats getEventQueueStats(APIPriority priority) const override {
+        return _eventQueue.getStats(priority);
     }
 
 private:
@@ -43,6 +58,7 @@ private:
         PROXY_SEND,     // Sending data to the proxy
         API_RECEIVE,    // Building an API command
         API_PROCESS,    // Processing an API command
+        API_WAIT,       // Waiting for a deferred API response
         API_RESPOND,    // Sending an API response
         EVENT           // Sending an event
     };
@@ -75,15 +91,22 @@ private:
         String response;    // Response to send
         size_t sendIndex;   // Position in the response
         bool processed;     // Indicates if the command has been processed
+        bool waiting;       // Response of a deferred method not available yet
+        unsigned long receivedAt;   // micros() at the start of the command line (trace)
+        APITrace trace;     // Trace of the command (empty if tracing is off)
         
         PendingCommand() 
             : sendIndex(0)
-            , processed(false) {}
+            , processed(false)
+            , waiting(false)
+            , receivedAt(0) {}
             
         PendingCommand(const String& cmd) 
             : command(cmd)
             , sendIndex(0)
-            , processed(false) {}
+            , processed(false)
+            , waiting(false)
+            , receivedAt(0) {}
     };
 
 
@@ -93,7 +116,8 @@ private:
         
         // Validate the command
         if (!cmd.method.isEmpty() && !cmd.path.isEmpty() && 
-            (cmd.method == "GET" || cmd.method == "SET" || cmd.method == "LIST")) {
+            (cmd.method == "GET" || cmd.method == "SET" || cmd.method == "LIST" ||
+             cmd.method == "SUB" || cmd.method == "UNSUB")) {
             cmd.valid = true;
         }
         
@@ -103,11 +127,11 @@ private:
             
 
     void processStateMachine() {
-        unsigned long now = millis();
+        bool traffic = false;       // Byte sent or received: the grace time restarts
         size_t processedChars = 0;
         
         // Check if we must return to mode NONE (timeout elapsed)
-        if (now - _lastTxRx > MODE_RESET_DELAY) {
+        if (_modeTimer.fired()) {
             switch (_mode) {
                 case SerialMode::API_RECEIVE:
                     if (_apiBufferOverflow) {
@@ -130,10 +154,19 @@ private:
 
                 case SerialMode::API_RESPOND:
                 case SerialMode::EVENT:
-                    if (_currentCommand.sendIndex >= _currentCommand.response.length()) {
-                        if (_mode == SerialMode::EVENT) {
-                            _currentCommand = PendingCommand();
+                    if (_currentCommand.sendIndex >= pendingOutput().length()) {
+                        // End the response line before the next output (events)
+                        if (_mode == SerialMode::API_RESPOND && !_currentCommand.response.endsWith("\n")) {
+                            _serial.write('\n');
+                        }
+                        // Sent: ready for the next command or event
+                        _currentCommand.trace.mark(APIStage::Sent);
+                        if (_currentEvent) {
+                            _currentEvent->trace().mark(APIStage::Sent);
+                            _currentEvent->trace().finish();
                         }
+                        _currentCommand = PendingCommand();
+                        _currentEvent.reset();
                         _mode = SerialMode::NONE;
                     }
                     break;
@@ -144,19 +177,19 @@ private:
         switch (_mode) {
             case SerialMode::NONE:
                 // Send events only if there is no active command
-                if (!_eventQueue.empty() && 
-                    _currentCommand.command.isEmpty() && 
-                    _currentCommand.response.isEmpty() && 
-                    _currentCommand.sendIndex == 0) {
+                if (canSendEvent()) {
+                    _currentEvent = _eventQueue.take();
                     _mode = SerialMode::EVENT;
+                    traffic = true;
                     break;
                 }
                 
                 // Check first if there is serial input
                 if (_serial.available()) {
                     char c = _serial.read();
-                    _lastTxRx = now;
+                    traffic = true;
                     if (c == '>') {
+                        _currentCommand.receivedAt = micros();
                         _mode = SerialMode::API_RECEIVE;
                         _apiBuffer[0] = c;
                         _apiBufferIndex = 1;
@@ -168,7 +201,7 @@ private:
                 // Otherwise check if the proxy has data to send
                 else if (proxy.availableForWrite()) {
                     _mode = SerialMode::PROXY_SEND;
-                    _lastTxRx = now;
+                    traffic = true;
                 }
                 break;
 
@@ -177,7 +210,7 @@ private:
                     char c = _serial.read();
                     proxy.writeToInput(c);
                     processedChars++;
-                    _lastTxRx = now;
+                    traffic = true;
                 }
                 break;
 
@@ -193,14 +226,14 @@ private:
                     if (bytesSent > 0) {
                         _serial.flush();
                     }
-                    _lastTxRx = now;
+                    traffic = true;
                 }
                 break;
 
             case SerialMode::API_RECEIVE:
                 while (_serial.available() && processedChars < RX_CHUNK_SIZE) {
                     char c = _serial.read();
-                    _lastTxRx = now;
+                    traffic = true;
                     processedChars++;
 
                     if (_apiBufferOverflow) continue;
@@ -227,29 +260,83 @@ private:
                 if (!_currentCommand.processed) {
                     handleCommand(_currentCommand);
                     _currentCommand.processed = true;
-                    _lastTxRx = now;
+                    traffic = true;
+                    if (!_currentCommand.waiting) {
+                        _currentCommand.trace.mark(APIStage::Queued);
+                    }
                 }
-                _mode = SerialMode::API_RESPOND;
+                // Deferred method: the completion switches to API_RESPOND (APIServer::poll)
+                _mode = _currentCommand.waiting ? SerialMode::API_WAIT : SerialMode::API_RESPOND;
+                break;
+
+            case SerialMode::API_WAIT:
                 break;
 
             case SerialMode::API_RESPOND:
-            case SerialMode::EVENT:
+            case SerialMode::EVENT: {
                 // Only enter while loop if there is data to send
-                if (_currentCommand.sendIndex < _currentCommand.response.length()) {
+                const String& output = pendingOutput();
+                if (_currentCommand.sendIndex < output.length()) {
                     int sentChunks = 0;
-                    // If MAX_TX_CHUNKS is 0, send all chunks (blocking)
-                    while (_currentCommand.sendIndex < _currentCommand.response.length() && (MAX_TX_CHUNKS == 0 || sentChunks < MAX_TX_CHUNKS)) {
-                        size_t remaining = _currentCommand.response.length() - _currentCommand.sendIndex;
+                    // If MAX_TX_CHUNKS is 0, send all chunks (blocking), unless the poll budget is spent
+                    while (_currentCommand.sendIndex < output.length() && (MAX_TX_CHUNKS == 0 || sentChunks < MAX_TX_CHUNKS) &&
+                           (sentChunks == 0 || !pollBudgetExpired())) {
+                        size_t remaining = output.length() - _currentCommand.sendIndex;
                         size_t chunkSize = min(TX_CHUNK_SIZE, remaining);
-                        _serial.write((uint8_t*)&_currentCommand.response[_currentCommand.sendIndex], chunkSize);
+                        _serial.write((const uint8_t*)output.c_str() + _currentCommand.sendIndex, chunkSize);
                         _serial.flush();
                         _currentCommand.sendIndex += chunkSize;
                         sentChunks++;
                     }
-                    _lastTxRx = now; // Reset timer after sending data
+                    traffic = true;  // Reset timer after sending data
                 }
                 break;
+            }
+        }
+
+        if (traffic) {
+            restartModeTimer();
+        }
+    }
+
+    // Grace time before returning to mode NONE, counted from the last byte sent or received
+    void restartModeTimer() {
+        _apiServer.scheduler().schedule(_modeTimer, MODE_RESET_DELAY);
+    }
+
+    // Events are sent only if there is no active command
+    bool canSendEvent() const {
+        return !_eventQueue.empty() &&
+               _currentCommand.command.isEmpty() &&
+               _currentCommand.response.isEmpty() &&
+               _currentCommand.sendIndex == 0;
+    }
+
+    // Check if the next poll can progress at once (otherwise: input, timeout or response awaited)
+    bool hasWorkNow() const {
+        switch (_mode) {
+            case SerialMode::NONE:
+                return canSendEvent() || _serial.available() || proxy.availableForWrite();
+            case SerialMode::PROXY_SEND:
+                return proxy.availableForWrite() > 0;
+            case SerialMode::API_PROCESS:
+                return true;
+            case SerialMode::API_RESPOND:
+            case SerialMode::EVENT:
+                return _currentCommand.sendIndex < pendingOutput().length();
+            default:
+                return _serial.available() > 0;
+        }
+    }
+
+    // Text being sent: the current event in EVENT mode, the command response otherwise
+    const String& pendingOutput() const {
+        if (_mode == SerialMode::EVENT && _currentEvent) {
+            return _currentEvent->encoded(APIEvent::FORMAT_TEXT, [](const APIEvent& event, String& output) {
+                output = "< " + SerialAPIFormatter::formatEvent(event.name(), event.data()) + "\n";
+            });
         }
+        return _currentCommand.response;
     }
 
     String formatError(const String& method, const String& path, const String& error) const {
@@ -262,31 +349,53 @@ private:
         
         // Validate the command
         cmd.valid = !cmd.method.isEmpty() && !cmd.path.isEmpty() && 
-            (cmd.method == "GET" || cmd.method == "SET" || cmd.method == "LIST");
+            (cmd.method == "GET" || cmd.method == "SET" || cmd.method == "LIST" ||
+             cmd.method == "SUB" || cmd.method == "UNSUB");
 
         if (!cmd.valid) {
             pendingCmd.response = "< " + formatError(cmd.method, cmd.path, "invalid command");
             return;
         }
 
-        // Handle GET api (simplified API doc) command separately
+        // Trace of the command, continued by the server and the completion (empty if tracing is off)
+        pendingCmd.trace = _apiServer.tracer().start(cmd.path, protocolId(PROTOCOL_SERIAL), false, pendingCmd.receivedAt);
+        APITrace::Scope scope(pendingCmd.trace);
+        pendingCmd.trace.mark(APIStage::Parsed);
+
+        // Handle GET api (simplified API doc) command separately, from the cached tree rendering
         if (cmd.method == "GET" && cmd.path == "api") {
-            JsonArray methods;
-            int methodCount = _apiServer.getAPIDoc(methods);
             pendingCmd.response = "< GET api\n";
-            pendingCmd.response += SerialAPIFormatter::formatAPIList(methods);
+            pendingCmd.response += *_apiServer.getDocRendering(DOC_FORMAT_SERIAL, [this](String& output) {
+                JsonDocument doc;
+                JsonArray methods = doc.to<JsonArray>();
+                _apiServer.getAPIDoc(methods);
+                output = SerialAPIFormatter::formatAPIList(methods);
+            });
+            return;
+        }
+
+        // Event subscription: SUB wifi/events / UNSUB wifi/events
+        if (cmd.method == "SUB" || cmd.method == "UNSUB") {
+            handleSubscription(pendingCmd, cmd);
+            return;
+        }
+
+        // Batch of GETs: GET _batch: paths=wifi/status;wifi/config
+        if (cmd.method == "GET" && cmd.path == APIServer::BATCH_PATH) {
+            handleBatch(pendingCmd, cmd);
             return;
         }
 
-        // Get available methods once
-        auto methods = _apiServer.getMethods("serial");
-        auto methodIt = methods.find(cmd.path);
-        if (methodIt == methods.end()) {
+        // Direct lookup in the registry snapshot (no copy, method valid while the reader is held)
+        APIServer::RegistryReader registry = _apiServer.readRegistry();
+        const APIMethod* methodPtr = APIServer::findMethod(*registry, protocolId(PROTOCOL_SERIAL), cmd.path);
+        if (!methodPtr) {
+            pendingCmd.trace.fail();
             pendingCmd.response = "< " + formatError(cmd.method, cmd.path, "method not found");
             return;
         }
 
-        const APIMethod& method = methodIt->second;
+        const APIMethod& method = *methodPtr;
 
         // Check authentication if required (with basic auth on Serial we only check the password)
         if (method.auth.enabled) {
@@ -294,6 +403,7 @@ private:
             
             if (authPass == cmd.params.end() || 
                 authPass->second != method.auth.password) {
+                pendingCmd.trace.fail();
                 pendingCmd.response = "< " + formatError(cmd.method, cmd.path, "authentication failed");
                 return;
             }
@@ -315,8 +425,8 @@ private:
                 String prefix = remainingKey.substring(0, remainingKey.indexOf('.'));
                 remainingKey = remainingKey.substring(remainingKey.indexOf('.') + 1);
                 
-                if (!current.containsKey(prefix)) {
-                    current = current.createNestedObject(prefix);
+                if (!current[prefix].is<JsonObject>()) {
+                    current = current[prefix].to<JsonObject>();
                 } else {
                     current = current[prefix];
                 }
@@ -326,38 +436,155 @@ private:
             current[remainingKey] = value;
         }
 
-        // Execute the method
-        StaticJsonDocument<512> responseDoc;
-        JsonObject response = responseDoc.to<JsonObject>();
-        
-        if (_apiServer.executeMethod("serial",cmd.path, cmd.params.empty() ? nullptr : &args, response)) {
-            pendingCmd.response = "< " + SerialAPIFormatter::formatResponse(cmd.method, cmd.path, response);
-        } else {
+        // Execute the method (the completion runs now, or later from APIServer::poll for deferred methods)
+        pendingCmd.waiting = true;
+        bool started = _apiServer.executeMethodAsync(protocolId(PROTOCOL_SERIAL), cmd.path,
+            cmd.params.empty() ? nullptr : &args,
+            [this, &pendingCmd, method = cmd.method, path = cmd.path](bool success, const JsonObject& response) {
+                if (success) {
+                    pendingCmd.response = "< " + SerialAPIFormatter::formatResponse(method, path, response);
+                } else {
+                    pendingCmd.response = "< " + formatError(method, path, "wrong request or parameters");
+                }
+                pendingCmd.trace.mark(APIStage::Serialized);
+                pendingCmd.trace.mark(APIStage::Queued);      // Sent by the TX state machine
+                if (pendingCmd.waiting && _mode == SerialMode::API_WAIT) {
+                    _mode = SerialMode::API_RESPOND;
+                    restartModeTimer();
+                    _apiServer.scheduler().wake();
+                }
+                pendingCmd.waiting = false;
+            });
+
+        if (!started) {
+            pendingCmd.waiting = false;
+            pendingCmd.trace.fail();
             pendingCmd.response = "< " + formatError(cmd.method, cmd.path, "wrong request or parameters");
         }
     }
 
+    /**
+     * @brief Subscribe to an EVT method (or "*"), or remove the subscription
+     */
+    void handleSubscription(PendingCommand& pendingCmd, const SerialCommand& cmd) {
+        bool subscribed = _subscriptions.count(cmd.path) > 0;
+        if (cmd.method == "SUB" && !subscribed) {
+            APIServer::RegistryReader registry = _apiServer.readRegistry();
+            const APIMethod* method = APIServer::findMethod(*registry, protocolId(PROTOCOL_SERIAL), cmd.path);
+            if (cmd.path != APISubscriptions::ALL && !(method && method->type == APIMethodType::EVT)) {
+                pendingCmd.response = "< " + formatError(cmd.method, cmd.path, "event not found");
+                return;
+            }
+            _subscriptions.add(cmd.path);
+            _apiServer.subscribe(cmd.path);
+            queueSnapshots(*registry, cmd.path);     // Latest value sent after the response
+        } else if (cmd.method == "UNSUB" && subscribed) {
+            _subscriptions.remove(cmd.path);
+            _apiServer.unsubscribe(cmd.path);
+        }
+        JsonDocument doc;
+        doc["subscribed"] = cmd.method == "SUB";
+        pendingCmd.response = "< " + SerialAPIFormatter::formatResponse(cmd.method, cmd.path, doc.as<JsonObject>());
+    }
+
+    /**
+     * @brief Queue the latest value of an event (or "*" = all)
+     */
+    void queueSnapshots(const APIRegistry& registry, const String& event) {
+        std::vector<APIEventRef> events = (event == APISubscriptions::ALL)
+            ? _apiServer.getEventSnapshots()
+            : std::vector<APIEventRef>{_apiServer.getEventSnapshot(event)};
+        for (const APIEventRef& snapshot : events) {
+            if (snapshot && APIServer::findMethod(registry, protocolId(PROTOCOL_SERIAL), snapshot->name())) {
+                queueEvent(snapshot);
+            }
+        }
+    }
+
+    /**
+     * @brief Run a batch of GETs, answer with one response line per method
+     */
+    void handleBatch(PendingCommand& pendingCmd, const SerialCommand& cmd) {
+        auto paths = cmd.params.find("paths");
+        if (paths == cmd.params.end() || paths->second.isEmpty()) {
+            pendingCmd.response = "< " + formatError(cmd.method, cmd.path, "missing paths");
+            return;
+        }
+
+        JsonDocument doc;
+        JsonArray calls = doc["calls"].to<JsonArray>();
+        String list = paths->second;
+        int start = 0;
+        while (start <= static_cast<int>(list.length())) {
+            int end = list.indexOf(';', start);
+            if (end == -1) end = list.length();
+            String path = list.substring(start, end);
+            path.trim();
+            if (!path.isEmpty()) {
+                calls.add<JsonObject>()["path"] = path;
+            }
+            start = end + 1;
+        }
+
+        pendingCmd.waiting = true;
+        JsonObject args = doc.as<JsonObject>();
+        bool started = _apiServer.executeBatch(protocolId(PROTOCOL_SERIAL), &args,
+            [this, &pendingCmd](bool, const JsonObject& response) {
+                pendingCmd.response = "";
+                for (JsonObject result : response["results"].as<JsonArray>()) {
+                    String path = result["path"].as<String>();
+                    if (!pendingCmd.response.isEmpty()) {
+                        pendingCmd.response += "\n";
+                    }
+                    if (result["success"].as<bool>()) {
+                        pendingCmd.response += "< " + SerialAPIFormatter::formatResponse("GET", path, result["response"].as<JsonObject>());
+                    } else {
+                        pendingCmd.response += "< " + formatError("GET", path, "wrong request or parameters");
+                    }
+                }
+                pendingCmd.trace.mark(APIStage::Serialized);
+                pendingCmd.trace.mark(APIStage::Queued);
+                if (pendingCmd.waiting && _mode == SerialMode::API_WAIT) {
+                    _mode = SerialMode::API_RESPOND;
+                    restartModeTimer();
+                    _apiServer.scheduler().wake();
+                }
+                pendingCmd.waiting = false;
+            });
+
+        if (!started) {
+            pendingCmd.waiting = false;
+            pendingCmd.response = "< " + formatError(cmd.method, cmd.path, "invalid batch");
+        }
+    }
+
     Stream& _serial;
 
     // Chunk sizes for asynchronous serial communication
     static constexpr size_t RX_CHUNK_SIZE = 256;            // =1 full hardware buffer (~30ms @ 9600bps)
     static constexpr size_t TX_CHUNK_SIZE = 128;            // =1/2 hardware buffer
     static constexpr size_t MAX_TX_CHUNKS = 0;              // Maximal number of chunks to process at each write cycle (0 = all chunks, blocking)
+    static constexpr size_t PROTOCOL_SERIAL = 0;            // Index of the "serial" protocol
+    static constexpr const char* DOC_FORMAT_SERIAL = "serial"; // Cache key of the API tree rendering
 
     // Event queue
-    std::queue<String> _eventQueue;                         // Queue of events to send
     static constexpr size_t QUEUE_SIZE = 10;                // Maximal number of events in the queue
+    APIEventQueue<QUEUE_SIZE> _eventQueue;                  // Queue of events to send (shared buffers)
+    APIEventRef _currentEvent;                              // Event being sent (EVENT mode)
+    APISubscriptions _subscriptions;                        // Events subscribed to (empty = all)
     
     // API Serial buffer
     static constexpr size_t API_BUFFER_SIZE = 4096;         // Buffer size for API commands    
     char _apiBuffer[API_BUFFER_SIZE];                       // Buffer for API commands
     size_t _apiBufferIndex;                                 // Index in the buffer
-    unsigned long _lastTxRx;                                // Last time a byte was sent or received
     
     // State machine
     SerialMode _mode = SerialMode::NONE;                    // Current state
     bool _apiBufferOverflow = false;                        // Indicates if the buffer has overflowed
     static constexpr unsigned long MODE_RESET_DELAY = 50;   // Grace time between modes
+    APITimer _modeTimer;                                    // Armed at each byte sent or received
+    static constexpr unsigned long POLL_INTERVAL = 10;      // Input checked at this interval when idle (no notification from the stream)
+    APITimer _pollTimer;
     PendingCommand _currentCommand;                         // Current command
     };
 
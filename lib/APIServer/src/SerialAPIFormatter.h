@@ -42,7 +42,7 @@ class SerialAPIFormatter {
         }
 
         static String formatEvent(const String& event, const JsonObject& data) {
-            return "EVT " + event + ": " + formatResponse("EVT", event, data);
+            return formatResponse("EVT", event, data);
         }
 
         static void parseCommandLine(const String& line, String& method, String& path, std::map<String, String>& params) {
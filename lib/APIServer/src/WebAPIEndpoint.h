@@ -3,12 +3,15 @@
 
 #include "APIServer.h"
 #include "APIEndpoint.h"
+#include "APIDocGenerator.h"
 #include <ESPAsyncWebServer.h>
 #include <AsyncWebSocket.h>
 #include <AsyncJson.h>
 #include <SPIFFS.h>
-#include <queue>
 #include <vector>
+#include <map>
+#include <set>
+#include <mutex>
 
 #define USE_DYNAMIC_JSON_ALLOC // Uncomment to use dynamic memory allocation for HTTP responses (AsyncJsonResponse)
 
@@ -65,9 +68,8 @@ public:
         : APIEndpoint(apiServer)
         , _server(port)
         , _ws(WS_ROUTE)
-        , _lastUpdate(0) 
     {
-        // Declare supported protocols
+        // Declare supported protocols (order must match PROTOCOL_HTTP / PROTOCOL_WS)
         addProtocol("http", GET | SET);
         if (WS_API_ENABLED) {
             addProtocol("websocket", GET | SET | EVT);
@@ -102,63 +104,109 @@ public:
     }
 
     void poll() override {
-        unsigned long now = millis();
-        if (now - _lastUpdate > WS_POLL_INTERVAL) {
+        if (_wsTimer.fired() || _wsBacklog) {
             processWsQueue();
-            _lastUpdate = now;
         }
     }
 
     void pushEvent(const String& event, const JsonObject& data) override {
-        StaticJsonDocument<1024> doc;
-        JsonObject eventObj = doc.to<JsonObject>();
-        eventObj["event"] = event;
-        eventObj["data"] = data;
-        
-        String message;
-        serializeJson(doc, message);
-        
-        if (_wsQueue.size() >= WS_QUEUE_SIZE) {
-            _wsQueue.pop();
+        queueEvent(std::make_shared<APIEvent>(event, data));
+    }
+
+    // Shared event: only the reference is queued, encoded once for all endpoints & clients
+    void queueEvent(const APIEventRef& event) override {
+        event->trace().mark(APIStage::Queued);
+        _wsQueue.push(event);
+        _apiServer.scheduler().arm(_wsTimer, WS_POLL_INTERVAL);     // Events of the window sent together
+    }
+
+    // A WebSocket client without subscription receives every event
+    bool hasSubscribers(const String& event) const override {
+        std::lock_guard<std::mutex> lock(_wsMutex);
+        for (const auto& [clientId, events] : _wsSubscriptions) {
+            if (receives(events, event)) {
+                return true;
+            }
         }
-        _wsQueue.push(message);
+        return false;
+    }
+
+    APIQueueStats getEventQueueStats(APIPriority priority) const override {
+        return _wsQueue.getStats(priority);
     }
 
 private:
-    AsyncWebServer _server;
-    AsyncWebSocket _ws;
-    unsigned long _lastUpdate;
-    std::queue<String> _wsQueue;
-    
-    static constexpr unsigned long WS_POLL_INTERVAL = 50;
+    static constexpr unsigned long WS_POLL_INTERVAL = 50;      // Events queued within this delay are sent together
     static constexpr size_t WS_QUEUE_SIZE = 10;
+    static constexpr size_t WS_FRAME_SIZE = 2048;              // Events queued together are packed up to this size
     static constexpr bool WS_API_ENABLED = false;
 
+    AsyncWebServer _server;
+    AsyncWebSocket _ws;
+    APITimer _wsTimer;                      // Armed by the first event (or replay) to send
+    APIEventQueue<WS_QUEUE_SIZE> _wsQueue;
+    std::vector<APIEventRef> _wsOutbox;     // Events taken from the queue, being sent (loop task)
+    bool _wsBacklog = false;                // Events left by a poll out of budget
+
+    // Event subscriptions of the connected WebSocket clients, by client ID (empty = all events)
+    static constexpr size_t WS_MAX_SUBSCRIPTIONS = 16;         // Per client
+    static constexpr size_t WS_MAX_REPLAYS = 32;               // Latest values waiting to be sent
+    std::map<uint32_t, std::set<String>> _wsSubscriptions;
+    std::vector<std::pair<uint32_t, String>> _wsReplays;      // Latest values to send (client ID, event or "*"), from poll
+    mutable std::mutex _wsMutex;                               // Updated from the AsyncTCP task
+
+    // Index of the declared protocols (see constructor)
+    static constexpr size_t PROTOCOL_HTTP = 0;
+    static constexpr size_t PROTOCOL_WS = 1;
+
     static constexpr size_t WS_JSON_BUF = 1024;
     static constexpr size_t GET_JSON_BUF = 2048;
     static constexpr size_t SET_JSON_BUF = 512;
-    static constexpr size_t DOC_JSON_BUF = 4096;
     static constexpr size_t MAX_REQUEST_SIZE = 4096;
 
     // Constants for routes and MIME types
     static constexpr const char* API_ROUTE = "/api";
+    static constexpr const char* API_PREFIX = "/api/";
+    static constexpr const char* API_DISPATCH_ROUTE = "/api/*";
+    static constexpr const char* OPENAPI_ROUTE = "/api/openapi.json";
     static constexpr const char* WS_ROUTE = "/api/events";
     static constexpr const char* MIME_JSON = "application/json";
     static constexpr const char* MIME_TEXT = "text/plain";
     static constexpr const char* ERROR_BAD_REQUEST = "{\"error\":\"Bad Request\"}";
     static constexpr const char* ERROR_NOT_FOUND = "Not Found";
+    static constexpr const char* ERROR_NOT_FOUND_JSON = "{\"error\":\"Not Found\"}";
+    static constexpr const char* ERROR_METHOD_NOT_ALLOWED = "{\"error\":\"Method Not Allowed\"}";
 
 
 
     void setupWebSocketEvents() {
         _ws.onEvent([this](AsyncWebSocket* server, AsyncWebSocketClient* client, 
                           AwsEventType type, void* arg, uint8_t* data, size_t len) {
-            if (type == WS_EVT_DATA) {
-                handleWebSocketMessage(arg, data, len);
+            if (type == WS_EVT_CONNECT) {
+                // New client: gets the latest value of every event at once
+                std::lock_guard<std::mutex> lock(_wsMutex);
+                _wsSubscriptions[client->id()];
+                queueReplay(client->id(), APISubscriptions::ALL);
+            } else if (type == WS_EVT_DISCONNECT) {
+                removeWsClient(client->id());
+            } else if (type == WS_EVT_DATA) {
+                handleWebSocketMessage(client, arg, data, len);
             }
         });
     }
 
+    void removeWsClient(uint32_t clientId) {
+        std::lock_guard<std::mutex> lock(_wsMutex);
+        auto it = _wsSubscriptions.find(clientId);
+        if (it == _wsSubscriptions.end()) {
+            return;
+        }
+        for (const String& event : it->second) {
+            _apiServer.unsubscribe(event);
+        }
+        _wsSubscriptions.erase(it);
+    }
+
     void setupAPIRoutes() {
         log("WEBAPI: Configuration des routes API...");
 
@@ -171,50 +219,165 @@ private:
             // Normal processing
         });
 
-        // GET methods (HTTP GET)
-        for (const auto& [path, method] : _apiServer.getMethods("http")) {
-            if (method.type == APIMethodType::GET) {
-                logf("WEBAPI: Enregistrement route GET /api/%s", path.c_str());
-                _server.on(("/api/" + path).c_str(), HTTP_GET, 
-                    [this, path, method](AsyncWebServerRequest *request) {  // Capture method ici
-                        logf("WEBAPI: Requête GET reçue sur /api/%s", path.c_str());
-
-                        // Check authentication directly with captured method
-                        if (!checkAuth(request, method)) {
-                            return; // 401 already sent by checkAuth
-                        }
-
-                        handleHTTPGet(request, path);
-                    });
+        // OpenAPI documentation (registered before the dispatcher, which would catch it)
+        _server.on(OPENAPI_ROUTE, HTTP_GET, [this](AsyncWebServerRequest *request) {
+            log("WEBAPI: Requête GET reçue sur /api/openapi.json");
+            handleOpenAPIDoc(request);
+        });
+
+        // Single dispatcher for all API methods (GET & SET): the path is parsed once
+        // and resolved through the APIServer registry, instead of one handler per route
+        _server.on(API_DISPATCH_ROUTE, HTTP_GET | HTTP_POST,
+            [this](AsyncWebServerRequest* request) {
+                handleAPIDispatch(request);
+            },
+            nullptr,
+            [](AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) {
+                bufferRequestBody(request, data, len, index, total);
+            });
+      
+        // API Documentation routes (HTTP GET)
+        _server.on(API_ROUTE, HTTP_GET, [this](AsyncWebServerRequest *request) {
+            log("WEBAPI: Requête GET reçue sur /api");
+            handleHTTPDoc(request);
+        });
+    }
+
+    /**
+     * @brief Accumulate the body of a SET request (stored in the request, freed with it)
+     */
+    static void bufferRequestBody(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) {
+        if (total > MAX_REQUEST_SIZE) {
+            return; // Rejected in handleAPIDispatch (Content-Length check)
+        }
+        if (index == 0) {
+            request->_tempObject = malloc(total + 1);
+        }
+        if (request->_tempObject) {
+            char* buffer = static_cast<char*>(request->_tempObject);
+            memcpy(buffer + index, data, len);
+            if (index + len == total) {
+                buffer[total] = '\0';
             }
         }
+    }
 
-        // SET methods (HTTP POST : implicitly handled by AsyncCallbackJsonWebHandler)
-        for (const auto& [path, method] : _apiServer.getMethods("http")) {
-            if (method.type == APIMethodType::SET) {
-                logf("WEBAPI: Enregistrement route SET /api/%s", path.c_str());
-                auto handler = new AsyncCallbackJsonWebHandler(
-                    ("/api/" + path).c_str(),
-                    [this, path, method](AsyncWebServerRequest* request, JsonVariant& json) {  // Capture method ici
-                        logf("WEBAPI: Requête SET reçue sur /api/%s", path.c_str());
+    /**
+     * @brief Resolve an /api/<path> request and route it to the GET or SET handler
+     */
+    void handleAPIDispatch(AsyncWebServerRequest* request) {
+        String path = request->url().substring(strlen(API_PREFIX));
+        if (path == APIServer::BATCH_PATH) {
+            handleHTTPBatch(request);
+            return;
+        }
 
-                        // Check authentication directly with captured method
-                        if (!checkAuth(request, method)) {
-                            return; // 401 already sent by checkAuth
-                        }
+        // Trace of the request (empty if tracing is off), continued by the server and the completion
+        APITrace trace = _apiServer.tracer().start(path, protocolId(PROTOCOL_HTTP));
+        APITrace::Scope scope(trace);
 
-                        handleHTTPSet(request, path, json.as<JsonObject>());
-                    }
-                );
-                _server.addHandler(handler);
+        APIServer::RegistryReader registry = _apiServer.readRegistry();  // Method valid until the end of dispatch
+        const APIMethod* method = APIServer::findMethod(*registry, protocolId(PROTOCOL_HTTP), path);
+        if (!method) {
+            logf("WEBAPI: Route inconnue /api/%s", path.c_str());
+            trace.fail();
+            request->send(404, MIME_JSON, ERROR_NOT_FOUND_JSON);
+            return;
+        }
+
+        // HTTP GET maps to GET methods, HTTP POST to SET methods
+        APIMethodType expectedType = (request->method() == HTTP_POST) ? APIMethodType::SET : APIMethodType::GET;
+        if (method->type != expectedType) {
+            trace.fail();
+            request->send(405, MIME_JSON, ERROR_METHOD_NOT_ALLOWED);
+            return;
+        }
+
+        if (!checkAuth(request, *method)) {
+            trace.fail();
+            return; // 401 already sent by checkAuth
+        }
+
+        if (method->type == APIMethodType::GET) {
+            logf("WEBAPI: Requête GET reçue sur /api/%s", path.c_str());
+            trace.mark(APIStage::Parsed);
+            // Same GET running in another task: joined asynchronously (AsyncTCP never waits for it)
+            if (method->deferred || _apiServer.hasWorker() || _apiServer.isCallRunning(path, nullptr)) {
+                // Rate limited before the cache lookup, like the synchronous GETs
+                if (!checkRateLimit()) {
+                    request->send(429, MIME_JSON, "{\"error\":\"Too Many Requests\"}");
+                    logf("WEBAPI: handleAPIDispatch - Requête GET rejetée pour %s (429 Too Many Requests)", path.c_str());
+                    trace.fail();
+                    return;
+                }
+                String cached;
+                if (method->cache.enabled && _apiServer.getCachedResponse(protocolId(PROTOCOL_HTTP), path, cached)) {
+                    request->send(200, MIME_JSON, cached);    // Cache hit: no need to wake the worker
+                    trace.mark(APIStage::Sent);
+                } else {
+                    startHTTPAsync(request, path, nullptr);
+                }
+            } else if (method->writer || method->cache.enabled) {
+                handleHTTPGetWriter(request, path);
+                trace.mark(APIStage::Sent);
+            } else {
+                handleHTTPGet(request, path);
+                trace.mark(APIStage::Sent);
             }
+            return;
         }
-      
-        // API Documentation route (HTTP GET)
-        _server.on(API_ROUTE, HTTP_GET, [this](AsyncWebServerRequest *request) {
-            log("WEBAPI: Requête GET reçue sur /api");
-            handleHTTPDoc(request);
-        });
+
+        logf("WEBAPI: Requête SET reçue sur /api/%s", path.c_str());
+        JsonDocument doc;
+        if (!parseRequestBody(request, doc)) {
+            trace.fail();
+            return; // Error already sent
+        }
+        trace.mark(APIStage::Parsed);
+        JsonObject args = doc.as<JsonObject>();
+        if (method->deferred || _apiServer.hasWorker()) {
+            handleHTTPAsync(request, path, &args);
+        } else {
+            handleHTTPSet(request, path, args);
+            trace.mark(APIStage::Sent);
+        }
+    }
+
+    /**
+     * @brief POST /api/_batch: run several methods, answer with their combined responses
+     */
+    void handleHTTPBatch(AsyncWebServerRequest* request) {
+        if (request->method() != HTTP_POST) {
+            request->send(405, MIME_JSON, ERROR_METHOD_NOT_ALLOWED);
+            return;
+        }
+        log("WEBAPI: Requête batch reçue sur /api/_batch");
+        JsonDocument doc;
+        if (!parseRequestBody(request, doc)) {
+            return; // Error already sent
+        }
+        JsonObject args = doc.as<JsonObject>();
+        handleHTTPAsync(request, APIServer::BATCH_PATH, &args, true);
+    }
+
+    /**
+     * @brief Parse the JSON object buffered by bufferRequestBody (sends the error response if invalid)
+     */
+    bool parseRequestBody(AsyncWebServerRequest* request, JsonDocument& doc) {
+        if (request->contentLength() > MAX_REQUEST_SIZE) {
+            request->send(413, MIME_TEXT, "Request size too large");
+            return false;
+        }
+        if (!request->_tempObject) {
+            request->send(400, MIME_JSON, ERROR_BAD_REQUEST);
+            return false;
+        }
+        DeserializationError error = deserializeJson(doc, static_cast<const char*>(request->_tempObject));
+        if (error || !doc.is<JsonObject>()) {
+            request->send(400, MIME_JSON, ERROR_BAD_REQUEST);
+            return false;
+        }
+        return true;
     }
 
     void setupStaticFiles() {
@@ -252,7 +415,7 @@ private:
         JsonObject root = response->getRoot();
         
         logf("WEBAPI: handleHTTPGet - Appel de executeMethod pour %s", path.c_str());
-        if (_apiServer.executeMethod("http", path, nullptr, root)) {
+        if (_apiServer.executeMethod(protocolId(PROTOCOL_HTTP), path, nullptr, root)) {
             // Debug de la réponse
             String debugResponse;
             serializeJson(root, debugResponse);
@@ -294,7 +457,7 @@ private:
         
         JsonObject root = response->getRoot();
         
-        if (_apiServer.executeMethod("http", path, &args, root)) {
+        if (_apiServer.executeMethod(protocolId(PROTOCOL_HTTP), path, &args, root)) {
             // Debug de la réponse
             String debugResponse;
             serializeJson(root, debugResponse);
@@ -310,20 +473,6 @@ private:
         }
     }
 
-    void handleHTTPDoc(AsyncWebServerRequest* request) {
-        // Création d'une réponse JSON asynchrone avec une capacité de 4KB
-        AsyncJsonResponse* response = new AsyncJsonResponse(DOC_JSON_BUF);
-        JsonArray methods = response->getRoot();
-        
-        // Génération de la documentation API
-        int methodCount = _apiServer.getAPIDoc(methods);
-        logf("WEBAPI: Documentation générée pour %d méthodes", methodCount);
-        
-        // Envoi de la réponse
-        response->setLength();
-        request->send(response);
-    }
-
     #else
 
     void handleHTTPGet(AsyncWebServerRequest* request, const String& path) {
@@ -340,7 +489,7 @@ private:
         JsonObject root = doc.to<JsonObject>();
 
         logf("WEBAPI: handleHTTPGet - Appel de executeMethod pour %s", path.c_str());
-        if (_apiServer.executeMethod("http",path, nullptr, root)) {
+        if (_apiServer.executeMethod(protocolId(PROTOCOL_HTTP), path, nullptr, root)) {
             // Debug de la réponse
             char responseBuffer[GET_JSON_BUF];
             serializeJson(doc, responseBuffer, GET_JSON_BUF);
@@ -374,7 +523,7 @@ private:
         StaticJsonDocument<SET_JSON_BUF> doc;
         JsonObject root = doc.to<JsonObject>();
 
-        if (_apiServer.executeMethod("http",path, &args, root)) {
+        if (_apiServer.executeMethod(protocolId(PROTOCOL_HTTP), path, &args, root)) {
             // Debug de la réponse
             char responseBuffer[SET_JSON_BUF];
             serializeJson(doc, responseBuffer, SET_JSON_BUF);
@@ -389,47 +538,196 @@ private:
             }
     }
 
-    void handleHTTPDoc(AsyncWebServerRequest* request) {
-        logf("WEBAPI: handleHTTPDoc - Génération de la documentation API");
+#endif
 
-        // StaticJsonDocument avec buffer alloué statiquement
-        StaticJsonDocument<DOC_JSON_BUF> doc;
-        JsonArray methods = doc.to<JsonArray>();
+    // GET methods with a response writer or a cached response: JSON text sent as is, no JsonDocument
+    void handleHTTPGetWriter(AsyncWebServerRequest* request, const String& path) {
+        if (!checkRateLimit()) {
+            request->send(429, MIME_JSON, "{\"error\":\"Too Many Requests\"}");
+            logf("WEBAPI: handleHTTPGetWriter - Requête GET rejetée pour %s (429 Too Many Requests)", path.c_str());
+            return;
+        }
 
-        // Génération de la documentation API
-        int methodCount = _apiServer.getAPIDoc(methods);
-        logf("WEBAPI: Documentation générée pour %d méthodes", methodCount);
+        // Body sent as streamed by the writer (not logged: no copy into the log buffer)
+        String body;
+        if (_apiServer.executeMethod(protocolId(PROTOCOL_HTTP), path, nullptr, body)) {
+            request->send(200, MIME_JSON, body);
+        } else {
+            logf("WEBAPI: handleHTTPGetWriter - Erreur lors de l'exécution de la méthode %s", path.c_str());
+            request->send(400, MIME_JSON, ERROR_BAD_REQUEST);
+        }
+    }
 
-        // Conversion en chaîne JSON pour l'envoi
-        char responseBuffer[DOC_JSON_BUF];
-        serializeJson(doc, responseBuffer, DOC_JSON_BUF);
+    /**
+     * @brief Request waiting for an asynchronous result, shared by its completion and its
+     * @brief disconnect hook. The completion runs on another task (loop, worker): it only uses
+     * @brief the request while holding the lock, and only if the client is still there. The
+     * @brief AsyncTCP task takes the same lock in onDisconnect, before freeing the request.
+     */
+    struct AsyncRequestGuard {
+        std::mutex mutex;
+        AsyncWebServerRequest* request;     // nullptr once the client is gone or answered
+    };
+
+    // Deferred methods, batches, or all methods with a worker task (GET & SET): the request
+    // stays open until the APIServer completes it
+    void handleHTTPAsync(AsyncWebServerRequest* request, const String& path, const JsonObject* args, bool batch = false) {
+        if (!checkRateLimit()) {
+            request->send(429, MIME_JSON, "{\"error\":\"Too Many Requests\"}");
+            logf("WEBAPI: handleHTTPAsync - Requête rejetée pour %s (429 Too Many Requests)", path.c_str());
+            return;
+        }
+        startHTTPAsync(request, path, args, batch);
+    }
+
+    // Start an asynchronous call (rate limit already checked)
+    void startHTTPAsync(AsyncWebServerRequest* request, const String& path, const JsonObject* args, bool batch = false) {
+        auto guard = std::make_shared<AsyncRequestGuard>();
+        guard->request = request;
+        APIPendingResponse pending;
+
+        // Registered before the call starts: it may complete on another task at once
+        request->onDisconnect([guard, pending]() mutable {
+            std::lock_guard<std::mutex> lock(guard->mutex);
+            guard->request = nullptr;   // Freed when this hook returns: the response must not be sent
+            pending.cancel();
+        });
 
-        // Envoi de la réponse
-        request->send(200, MIME_JSON, responseBuffer);
-        logf("WEBAPI: handleHTTPDoc - Réponse envoyée avec succès");
+        APIServer::Completion onComplete = [this, guard, path](bool success, const JsonObject& response) {
+            String body;
+            if (success) {
+                serializeJson(response, body);
+                APITrace::markCurrent(APIStage::Serialized);
+                logf("WEBAPI: handleHTTPAsync - Réponse générée: %s", body.c_str());
+            } else {
+                logf("WEBAPI: handleHTTPAsync - Erreur lors de l'exécution de la méthode %s", path.c_str());
+            }
+            std::lock_guard<std::mutex> lock(guard->mutex);
+            if (!guard->request) {
+                return;     // Client gone
+            }
+            if (success) {
+                guard->request->send(200, MIME_JSON, body);
+                APITrace::markCurrent(APIStage::Sent);
+            } else {
+                guard->request->send(400, MIME_JSON, ERROR_BAD_REQUEST);
+            }
+            guard->request = nullptr;
+        };
+        bool started = batch ? _apiServer.executeBatch(protocolId(PROTOCOL_HTTP), args, onComplete, &pending)
+                             : _apiServer.executeMethodAsync(protocolId(PROTOCOL_HTTP), path, args, onComplete, &pending);
+
+        if (!started) {
+            logf("WEBAPI: handleHTTPAsync - Impossible de lancer la méthode %s", path.c_str());
+            APITrace::failCurrent();
+            std::lock_guard<std::mutex> lock(guard->mutex);
+            guard->request = nullptr;
+            request->send(400, MIME_JSON, ERROR_BAD_REQUEST);
+        }
     }
 
-#endif
+    // API documentation, served from the renderings cached by the API server
+    void handleHTTPDoc(AsyncWebServerRequest* request) {
+        sendCachedDoc(request, APIServer::DOC_FORMAT_JSON, [this]() {
+            return _apiServer.getAPIDocJson();
+        });
+    }
 
-    void handleWebSocketMessage(void* arg, uint8_t* data, size_t len) {
-        if (!WS_API_ENABLED) return;
-        
+    void handleOpenAPIDoc(AsyncWebServerRequest* request) {
+        sendCachedDoc(request, APIDocGenerator::DOC_FORMAT_OPENAPI, [this]() {
+            return APIDocGenerator::getOpenAPIDoc(_apiServer);
+        });
+    }
+
+    /**
+     * @brief Send a cached documentation buffer (no JSON work, no copy)
+     * @brief Answers 304 if the client already has the current version (ETag of this rendering).
+     */
+    void sendCachedDoc(AsyncWebServerRequest* request, const char* format, const APIServer::DocSource& source) {
+        APIServer::DocRendering etag = _apiServer.getDocETag(format, source);
+        if (request->hasHeader("If-None-Match") && request->header("If-None-Match") == *etag) {
+            request->send(304);
+            return;
+        }
+        APIServer::DocRendering doc = source();
+        // Streamed from the cached buffer: the response holds a reference, so a registration
+        // dropping the cache while the response is sent does not free it
+        AsyncWebServerResponse* response = request->beginResponse(MIME_JSON, doc->length(),
+            [doc](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+                size_t length = std::min(maxLen, doc->length() - index);
+                memcpy(buffer, doc->c_str() + index, length);
+                return length;
+            });
+        response->addHeader("ETag", *etag);
+        request->send(response);
+    }
+
+    void handleWebSocketMessage(AsyncWebSocketClient* client, void* arg, uint8_t* data, size_t len) {
         AwsFrameInfo* info = (AwsFrameInfo*)arg;
         if (info->final && info->index == 0 && info->len == len && 
             info->opcode == WS_TEXT) {
-            
+            unsigned long receivedAt = micros();    // Start of the trace if this is an API request
+
             StaticJsonDocument<WS_JSON_BUF> doc;
-            DeserializationError error = deserializeJson(doc, (char*)data);
+            DeserializationError error = deserializeJson(doc, (char*)data, len);
             
             if (!error) {
                 JsonObject request = doc.as<JsonObject>();
-                if (request.containsKey("method")) {
+                if (request.containsKey("subscribe") || request.containsKey("unsubscribe")) {
+                    handleSubscription(client->id(), request);
+                } else if (request.containsKey("resync")) {
+                    // Delta event: full value requested after a sequence gap
+                    std::lock_guard<std::mutex> lock(_wsMutex);
+                    queueReplay(client->id(), request["resync"].as<String>());
+                } else if (WS_API_ENABLED && request.containsKey("method")) {
+                    APITrace trace = _apiServer.tracer().start(request["method"].as<String>(), protocolId(PROTOCOL_WS), false, receivedAt);
+                    APITrace::Scope scope(trace);
+                    trace.mark(APIStage::Parsed);
                     handleAPIRequest(request);
                 }
             }
         }
     }
 
+    /**
+     * @brief {"subscribe":"wifi/events"} or {"unsubscribe":["a","b"]}: events sent to a client
+     * @brief Only EVT methods available over WebSocket (or "*") can be subscribed to.
+     */
+    void handleSubscription(uint32_t clientId, const JsonObject& request) {
+        bool subscribe = request.containsKey("subscribe");
+        JsonVariant list = subscribe ? request["subscribe"] : request["unsubscribe"];
+        std::vector<String> events;
+        if (list.is<JsonArray>()) {
+            for (JsonVariant event : list.as<JsonArray>()) {
+                events.push_back(event.as<String>());
+            }
+        } else {
+            events.push_back(list.as<String>());
+        }
+
+        APIServer::RegistryReader registry = _apiServer.readRegistry();
+        std::lock_guard<std::mutex> lock(_wsMutex);
+        std::set<String>& subscribed = _wsSubscriptions[clientId];
+        for (const String& event : events) {
+            if (!subscribe) {
+                if (subscribed.erase(event)) {
+                    _apiServer.unsubscribe(event);
+                }
+                continue;
+            }
+            const APIMethod* method = APIServer::findMethod(*registry, protocolId(PROTOCOL_WS), event);
+            bool valid = event == APISubscriptions::ALL || (method && method->type == APIMethodType::EVT);
+            if (!valid || subscribed.size() >= WS_MAX_SUBSCRIPTIONS) {
+                logf("WEBAPI: Abonnement refusé à %s (client %u)", event.c_str(), (unsigned)clientId);
+                continue;
+            }
+            if (subscribed.insert(event).second) {
+                _apiServer.subscribe(event);
+                queueReplay(clientId, event);
+            }
+        }
+    }
+
     void handleAPIRequest(const JsonObject& request) {
         if (!WS_API_ENABLED) return;
         
@@ -438,19 +736,157 @@ private:
         
         String method = request["method"].as<String>();
         JsonObject params = request["params"].as<JsonObject>();
+
+        // Batch: {"method":"_batch","params":{"calls":[...]}}, combined response broadcast when done
+        if (method == APIServer::BATCH_PATH) {
+            _apiServer.executeBatch(protocolId(PROTOCOL_WS), &params, [this](bool, const JsonObject& response) {
+                String responseStr;
+                serializeJson(response, responseStr);
+                APITrace::markCurrent(APIStage::Serialized);
+                _ws.textAll(responseStr);
+                APITrace::markCurrent(APIStage::Sent);
+            });
+            return;
+        }
         
-        if (_apiServer.executeMethod("websocket", method, &params, response)) {
+        if (_apiServer.isDeferred(protocolId(PROTOCOL_WS), method) || _apiServer.hasWorker()) {
+            // Response broadcast once completed (from APIServer::poll)
+            _apiServer.executeMethodAsync(protocolId(PROTOCOL_WS), method, &params,
+                [this](bool success, const JsonObject& response) {
+                    if (success) {
+                        String responseStr;
+                        serializeJson(response, responseStr);
+                        APITrace::markCurrent(APIStage::Serialized);
+                        _ws.textAll(responseStr);
+                        APITrace::markCurrent(APIStage::Sent);
+                    }
+                });
+            return;
+        }
+
+        if (_apiServer.executeMethod(protocolId(PROTOCOL_WS), method, &params, response)) {
             String responseStr;
             serializeJson(doc, responseStr);
+            APITrace::markCurrent(APIStage::Serialized);
             _ws.textAll(responseStr);
+            APITrace::markCurrent(APIStage::Sent);
         }
     }
 
     void processWsQueue() {
-        while (!_wsQueue.empty()) {
-            String message = _wsQueue.front();
-            _wsQueue.pop();
-            _ws.textAll(message);
+        _wsBacklog = false;
+        processWsReplays();
+        if (_wsOutbox.empty()) {
+            _wsQueue.take(_wsOutbox);   // Sent without the queue lock: broadcasts are not blocked
+        }
+        if (_wsOutbox.empty()) {
+            return;
+        }
+
+        // Clients receiving every event, and subscriptions of the others (copied: no lock while sending)
+        std::vector<uint32_t> allEvents;
+        std::vector<std::pair<uint32_t, std::set<String>>> filtered;
+        {
+            std::lock_guard<std::mutex> lock(_wsMutex);
+            for (const auto& [clientId, events] : _wsSubscriptions) {
+                if (events.empty() || events.count(APISubscriptions::ALL)) {
+                    allEvents.push_back(clientId);
+                } else {
+                    filtered.emplace_back(clientId, events);
+                }
+            }
+        }
+
+        // No subscription: one frame for the events queued since the last poll, sent to all clients
+        if (filtered.empty()) {
+            String buffer;
+            size_t count;
+            while (!_wsOutbox.empty()) {
+                _ws.textAll(packEvents(_wsOutbox, WS_FRAME_SIZE, buffer, count));
+                markEventsSent(_wsOutbox, count);
+                _wsOutbox.erase(_wsOutbox.begin(), _wsOutbox.begin() + count);
+                if (!_wsOutbox.empty() && pollBudgetExpired()) {
+                    _wsBacklog = true;     // Rest sent at the next poll, without waiting for the interval
+                    _apiServer.scheduler().wake();
+                    break;
+                }
+            }
+            return;
+        }
+
+        std::vector<APIEventRef> events;
+        events.swap(_wsOutbox);
+
+        sendEvents(events, allEvents);
+        for (const auto& [clientId, subscribed] : filtered) {
+            std::vector<APIEventRef> selected;
+            for (const APIEventRef& event : events) {
+                if (subscribed.count(event->name())) {
+                    selected.push_back(event);
+                }
+            }
+            sendEvents(selected, {clientId});
+        }
+        markEventsSent(events, events.size());
+    }
+
+    // Latest value of an event (or "*" = all) to send to a client from poll (caller holds _wsMutex)
+    void queueReplay(uint32_t clientId, const String& event) {
+        if (_wsReplays.size() < WS_MAX_REPLAYS) {
+            _wsReplays.emplace_back(clientId, event);
+            _apiServer.scheduler().arm(_wsTimer, 0);
+        }
+    }
+
+    // Latest values sent to new clients, new subscriptions and resyncs (full value of delta events)
+    void processWsReplays() {
+        std::vector<std::pair<uint32_t, String>> replays;
+        std::map<uint32_t, std::set<String>> subscriptions;
+        {
+            std::lock_guard<std::mutex> lock(_wsMutex);
+            if (_wsReplays.empty()) {
+                return;
+            }
+            replays.swap(_wsReplays);
+            subscriptions = _wsSubscriptions;
+        }
+        APIServer::RegistryReader registry = _apiServer.readRegistry();
+        std::set<std::pair<uint32_t, String>> sent;
+        for (const auto& [clientId, event] : replays) {
+            auto client = subscriptions.find(clientId);
+            if (client == subscriptions.end()) {
+                continue;   // Disconnected meanwhile
+            }
+            std::vector<APIEventRef> events = (event == APISubscriptions::ALL)
+                ? _apiServer.getEventSnapshots()
+                : std::vector<APIEventRef>{_apiServer.getEventSnapshot(event)};
+            for (const APIEventRef& snapshot : events) {
+                if (!snapshot || !receives(client->second, snapshot->name()) ||
+                    !APIServer::findMethod(*registry, protocolId(PROTOCOL_WS), snapshot->name())) {
+                    continue;
+                }
+                if (sent.emplace(clientId, snapshot->name()).second) {
+                    _ws.text(clientId, snapshot->snapshot());
+                }
+            }
+        }
+    }
+
+    // Check if a client with these subscriptions receives an event
+    static bool receives(const std::set<String>& subscribed, const String& event) {
+        return subscribed.empty() || subscribed.count(event) || subscribed.count(APISubscriptions::ALL);
+    }
+
+    // Send events to some clients, packed (the frames are built once for all of them)
+    void sendEvents(std::vector<APIEventRef> events, const std::vector<uint32_t>& clients) {
+        String buffer;
+        size_t count;
+        while (!events.empty() && !clients.empty()) {
+            const String& frame = packEvents(events, WS_FRAME_SIZE, buffer, count);
+            for (uint32_t clientId : clients) {
+                _ws.text(clientId, frame);
+            }
+            events.erase(events.begin(), events.begin() + count);
         }
     }
 };
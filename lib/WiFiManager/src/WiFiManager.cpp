@@ -77,24 +77,28 @@ void WiFiManager::refreshSTAStatus() {
     staStatus.rssi = WiFi.RSSI();
 }
 
-/* @brief Periodically check the state */
+/* @brief Periodically check the state (every POLL_INTERVAL) */
 /* @return void */
 void WiFiManager::poll() {
     
     unsigned long now = millis();
     if (now - lastConnectionCheck >= POLL_INTERVAL) {
         lastConnectionCheck = now;
-        
-        // Refresh status
-        refreshAPStatus();
-        refreshSTAStatus();
-        
-        // Handle reconnections if necessary
-        handleReconnections();
-        
+        checkState();
     }
 }
 
+/* @brief Check the state now (the caller sets the pace, e.g. with a timer) */
+/* @return void */
+void WiFiManager::checkState() {
+    // Refresh status
+    refreshAPStatus();
+    refreshSTAStatus();
+    
+    // Handle reconnections if necessary (timeouts measured from the attempt, seen at the next check)
+    handleReconnections();
+}
+
 /* @brief Handle reconnections */
 /* @return void */
 void WiFiManager::handleReconnections() {
@@ -468,26 +472,47 @@ String WiFiManager::getHostname() {
     return hostname;
 }
 
-/* @brief Scan available networks */
+/* @brief Scan available networks (blocking, see startScan for the asynchronous scan) */
 /* @param JsonObject& obj : JSON object to store the results */
 /* @return void */
 void WiFiManager::getAvailableNetworks(JsonObject& obj) {
-    int n = WiFi.scanNetworks();
+    WiFi.scanNetworks();
+    getScanResults(obj);
+}
+
+/* @brief Start an asynchronous scan (results available when scanComplete() >= 0) */
+/* @return bool : true if a scan is running */
+bool WiFiManager::startScan() {
+    if (WiFi.scanComplete() == WIFI_SCAN_RUNNING) {
+        return true;
+    }
+    return WiFi.scanNetworks(true) == WIFI_SCAN_RUNNING;
+}
+
+/* @brief Get the state of the asynchronous scan */
+/* @return int : number of networks found, WIFI_SCAN_RUNNING or WIFI_SCAN_FAILED */
+int WiFiManager::scanComplete() {
+    return WiFi.scanComplete();
+}
+
+/* @brief Copy the results of the last scan, then free them */
+/* @param JsonObject& obj : JSON object to store the results */
+/* @return void */
+void WiFiManager::getScanResults(JsonObject& obj) {
+    int n = WiFi.scanComplete();
     if (n > 10) {  // Arbitrary limit for safety
         n = 10;
     }
-    StaticJsonDocument<1024> doc;
-    JsonArray networksArray = doc["networks"].to<JsonArray>();
+    JsonArray networksArray = obj["networks"].to<JsonArray>();
     for (int i = 0; i < n; ++i) {
         uint8_t encType = static_cast<uint8_t>(WiFi.encryptionType(i));
         encType = encType < 12 ? encType : 12;
-        JsonObject networkInfo;
+        JsonObject networkInfo = networksArray.add<JsonObject>();
         networkInfo["ssid"] =       WiFi.SSID(i);
         networkInfo["rssi"] =       WiFi.RSSI(i);
         networkInfo["encryption"] = AUTH_MODE_STRINGS[encType];
-        networksArray.add(networkInfo);
     }
-    obj = doc.to<JsonObject>();
+    WiFi.scanDelete();
 }
 
 
@@ -150,9 +150,16 @@ public:
     bool setSTAConfigFromJson(const JsonObject& config);
     void getAvailableNetworks(JsonObject& obj);
 
+    // Asynchronous scan (the WiFi driver scans in background)
+    bool startScan();
+    int scanComplete();
+    void getScanResults(JsonObject& obj);
+
     // Getters for status and configuration
     void getStatusToJson(JsonObject& obj) const;
     void getConfigToJson(JsonObject& obj) const;
+    const ConnectionStatus& getAPStatus() const { return apStatus; }
+    const ConnectionStatus& getSTAStatus() const { return staStatus; }
 
     // Hostname management
     bool setHostname(const String& name);
@@ -162,12 +169,17 @@ public:
     void refreshAPStatus();
     void refreshSTAStatus();
 
-    // Main loop method
+    // Main loop method (checks the state every POLL_INTERVAL)
     void poll();
 
+    // Check the state now, instead of poll() when the caller times the checks (APITimer)
+    void checkState();
+
     // Method to register a state change callback (API server notifications)
     void onStateChange(std::function<void()> callback);
 
+    static constexpr unsigned long POLL_INTERVAL = 2000;        // 2 seconds between status updates (poll() must run at least as often)
+
 private:
     // WiFi status and configuration
     String hostname;
@@ -176,7 +188,6 @@ private:
     StaticJsonDocument<256> _lastStatus;
 
     // WiFi connection parameters
-    static constexpr unsigned long POLL_INTERVAL = 2000;        // 2 seconds between status updates
     static constexpr unsigned long CONNECTION_TIMEOUT = 30000;  // 30 seconds timeout for connection attempts
     static constexpr unsigned long RETRY_INTERVAL = 30000;      // 30 seconds between retries after disconnection
     unsigned long lastConnectionCheck = 0;
@@ -10,13 +10,15 @@ public:
     WiFiManagerAPI(WiFiManager& wifiManager, APIServer& apiServer) 
         : _wifiManager(wifiManager)
         , _apiServer(apiServer)
-        , _lastNotification(0)
-        , _lastHeartbeat(0)
     {
         // Subscribe to WiFi state changes
         _wifiManager.onStateChange([this]() {
             sendNotification(true);
         });
+
+        // State compared at each notification tick, heartbeat sent if nothing changed meanwhile
+        _apiServer.scheduler().every(_notificationTimer, NOTIFICATION_INTERVAL);
+        setHeartbeatInterval(HEARTBEAT_INTERVAL);
         
         registerMethods();
     }
@@ -26,30 +28,54 @@ public:
      * 
      * Must be called regularly in the main loop.
      * Sends updates via WebSocket when state changes are detected
-     * and the minimum interval has elapsed.
+     * at the notification tick (timers of the APIServer scheduler).
      */
     void poll() {
-        unsigned long now = millis();
-        if (now - _lastNotification > NOTIFICATION_INTERVAL) {
-            if (sendNotification(false)) _lastNotification = now;
+        if (_notificationTimer.fired()) {
+            sendNotification(false);
+        }
+        pollScan();
+    }
+
+    /**
+     * @brief Set the interval of the heartbeat (state broadcast even without change)
+     * @param interval Interval in ms, 0 to disable: new clients get the latest state from the
+     * APIServer at once, so the heartbeat is only needed by clients watching the connection
+     */
+    void setHeartbeatInterval(unsigned long interval) {
+        _heartbeatInterval = interval;
+        if (interval) {
+            _apiServer.scheduler().every(_heartbeatTimer, interval);
+        } else {
+            _apiServer.scheduler().cancel(_heartbeatTimer);
         }
     }
 
 private:
     WiFiManager& _wifiManager;
     APIServer& _apiServer;
-    unsigned long _lastNotification;
-    unsigned long _lastHeartbeat;
+    APITimer _notificationTimer;
+    APITimer _heartbeatTimer;
+    unsigned long _heartbeatInterval = 0;
+    APITimer _scanTimer;
     StaticJsonDocument<1024> _previousState;
     static constexpr unsigned long NOTIFICATION_INTERVAL = 500;
     static constexpr unsigned long HEARTBEAT_INTERVAL = 5000;
+    static constexpr unsigned long SCAN_CHECK_INTERVAL = 100;   // Scan progress checked at this interval while requests wait
+    static constexpr uint32_t EVENT_COALESCE_WINDOW = 200;     // State changes of one reconfiguration sent as one event
+    std::vector<APIPendingResponse> _scanWaiters;  // GET wifi/scan requests waiting for the scan
+
+    // Arguments of SET wifi/hostname (decoded by the APIServer)
+    struct HostnameArgs {
+        String hostname;
+    };
 
 
 
     /**
      * @brief Register the methods to the API server
      */
-    void registerMethods() const {
+    void registerMethods() {
 
         //@API_DOC_SECTION_START
         // API Module name (must be consistent between module info & registerMethod calls)
@@ -62,38 +88,107 @@ private:
             "1.0.0"                                      // Version
         );
 
+        // Method schemas: static constexpr descriptors, kept in flash (shared between methods)
+        static constexpr APIParamDescriptor STATUS_FIELDS[] = {
+            {"enabled",     APIParamType::Boolean},
+            {"busy",        APIParamType::Boolean},
+            {"connected",   APIParamType::Boolean},
+            {"ip",          APIParamType::String},
+            {"rssi",        APIParamType::Integer, false},    // STA only
+            {"clients",     APIParamType::Integer, false}     // AP only
+        };
+        static constexpr APIParamDescriptor AP_CONFIG_FIELDS[] = {
+            {"enabled",     APIParamType::Boolean},
+            {"ssid",        APIParamType::String},
+            {"password",    APIParamType::String},
+            {"channel",     APIParamType::Integer},
+            {"ip",          APIParamType::String},
+            {"gateway",     APIParamType::String},
+            {"subnet",      APIParamType::String}
+        };
+        static constexpr APIParamDescriptor STA_CONFIG_FIELDS[] = {
+            {"enabled",     APIParamType::Boolean},
+            {"ssid",        APIParamType::String},
+            {"password",    APIParamType::String},
+            {"dhcp",        APIParamType::Boolean},
+            {"ip",          APIParamType::String},
+            {"gateway",     APIParamType::String},
+            {"subnet",      APIParamType::String}
+        };
+        static constexpr APIParamDescriptor STATUS_RESPONSE[] = {
+            {"ap",          STATUS_FIELDS},
+            {"sta",         STATUS_FIELDS}
+        };
+        static constexpr APIParamDescriptor CONFIG_RESPONSE[] = {
+            {"ap",          AP_CONFIG_FIELDS},
+            {"sta",         STA_CONFIG_FIELDS}
+        };
+        static constexpr APIParamDescriptor NETWORK_FIELDS[] = {
+            {"ssid",        APIParamType::String},
+            {"rssi",        APIParamType::Integer},
+            {"encryption",  APIParamType::Integer}
+        };
+        static constexpr APIParamDescriptor SCAN_RESPONSE[] = {
+            {"networks",    NETWORK_FIELDS}
+        };
+        static constexpr APIParamDescriptor AP_CONFIG_PARAMS[] = {
+            {"enabled",     APIParamType::Boolean},
+            {"ssid",        APIParamType::String},
+            {"password",    APIParamType::String},
+            {"channel",     APIParamType::Integer},
+            {"ip",          APIParamType::String, false},     // Optional
+            {"gateway",     APIParamType::String, false},     // Optional
+            {"subnet",      APIParamType::String, false}      // Optional
+        };
+        static constexpr APIParamDescriptor STA_CONFIG_PARAMS[] = {
+            {"enabled",     APIParamType::Boolean},
+            {"ssid",        APIParamType::String},
+            {"password",    APIParamType::String},
+            {"dhcp",        APIParamType::Boolean},
+            {"ip",          APIParamType::String, false},     // Optional
+            {"gateway",     APIParamType::String, false},     // Optional
+            {"subnet",      APIParamType::String, false}      // Optional
+        };
+        static constexpr APIParamDescriptor SUCCESS_RESPONSE[] = {
+            {"success",     APIParamType::Boolean}
+        };
+        static constexpr APIParamDescriptor EVENT_RESPONSE[] = {
+            {"status",      STATUS_RESPONSE},
+            {"config",      CONFIG_RESPONSE}
+        };
+
+        // Cached GET wifi/config: only changes through the AP/STA config methods
+        static constexpr const char* CONFIG_CACHE_KEYS[] = {"wifi/config"};
+
+        static constexpr APIMethodDescriptor STATUS_METHOD =
+            APIMethodDescriptor(APIMethodType::GET, "Get WiFi status").response(STATUS_RESPONSE);
+        static constexpr APIMethodDescriptor CONFIG_METHOD =
+            APIMethodDescriptor(APIMethodType::GET, "Get WiFi configuration").response(CONFIG_RESPONSE).cache();
+        static constexpr APIMethodDescriptor SCAN_METHOD =
+            APIMethodDescriptor(APIMethodType::GET, "Scan available WiFi networks").response(SCAN_RESPONSE);
+        static constexpr APIMethodDescriptor AP_CONFIG_METHOD =
+            APIMethodDescriptor(APIMethodType::SET, "Configure Access Point").params(AP_CONFIG_PARAMS).response(SUCCESS_RESPONSE)
+                .invalidates(CONFIG_CACHE_KEYS).priority(APIPriority::Control);
+        static constexpr APIMethodDescriptor STA_CONFIG_METHOD =
+            APIMethodDescriptor(APIMethodType::SET, "Configure Station mode").params(STA_CONFIG_PARAMS).response(SUCCESS_RESPONSE)
+                .invalidates(CONFIG_CACHE_KEYS).priority(APIPriority::Control);
+        static constexpr APIMethodDescriptor EVENTS_METHOD =
+            APIMethodDescriptor(APIMethodType::EVT, "WiFi status and configuration updates").response(EVENT_RESPONSE)
+                .coalesce(EVENT_COALESCE_WINDOW).deltaEncoded().priority(APIPriority::Telemetry);
+
         // GET wifi/status
-        _apiServer.registerMethod(APIMODULE_NAME, "wifi/status", 
-            APIMethodBuilder(APIMethodType::GET, [this](const JsonObject* args, JsonObject& response) {
+        _apiServer.registerMethod(APIMODULE_NAME, "wifi/status", STATUS_METHOD,
+            [this](const JsonObject*, APIResponseWriter& writer) {
                 Serial.println("WIFIAPI: Exécution de GET wifi/status");
-                _wifiManager.getStatusToJson(response);
-                
-                String debug;
-                serializeJson(response, debug);
-                Serial.printf("WIFIAPI: Réponse status: %s\n", debug.c_str());
-                
+                writeStatus(writer, "ap", _wifiManager.getAPStatus());
+                writeStatus(writer, "sta", _wifiManager.getSTAStatus());
                 return true;
-            })
-            .desc("Get WiFi status")
-            .response("ap", {
-                {"enabled", APIParamType::Boolean},
-                {"connected", APIParamType::Boolean},
-                {"clients", APIParamType::Integer},
-                {"ip", APIParamType::String},
-                {"rssi", APIParamType::Integer}
-            })
-            .response("sta", {
-                {"enabled", APIParamType::Boolean},
-                {"connected", APIParamType::Boolean},
-                {"ip", APIParamType::String},
-                {"rssi", APIParamType::Integer}
-            })
-            .build()
+            }
         );
 
         // GET wifi/config
-        _apiServer.registerMethod(APIMODULE_NAME, "wifi/config",
-            APIMethodBuilder(APIMethodType::GET, [this](const JsonObject* args, JsonObject& response) {
+        _apiServer.registerMethod(APIMODULE_NAME, "wifi/config", CONFIG_METHOD,
+            [this](const JsonObject*, JsonObject& response) {
                 Serial.println("WIFIAPI: Exécution de GET wifi/config");
                 _wifiManager.getConfigToJson(response);
                 
@@ -102,157 +197,115 @@ private:
                 Serial.printf("WIFIAPI: Réponse config: %s\n", debug.c_str());
                 
                 return true;
-            })
-            .desc("Get WiFi configuration")
-            .response("ap", {
-                {"enabled",     APIParamType::Boolean},
-                {"ssid",        APIParamType::String},
-                {"password",    APIParamType::String},
-                {"channel",     APIParamType::Integer},
-                {"ip",          APIParamType::String},
-                {"gateway",     APIParamType::String},
-                {"subnet",      APIParamType::String}
-            })
-            .response("sta", {
-                {"enabled",     APIParamType::Boolean},
-                {"ssid",        APIParamType::String},
-                {"password",    APIParamType::String},
-                {"dhcp",        APIParamType::Boolean},
-                {"ip",          APIParamType::String},
-                {"gateway",     APIParamType::String},
-                {"subnet",      APIParamType::String}
-            })
-            .build()
+            }
         );
 
-        // GET wifi/scan
-        _apiServer.registerMethod(APIMODULE_NAME, "wifi/scan",
-            APIMethodBuilder(APIMethodType::GET, [this](const JsonObject* args, JsonObject& response) {
+        // GET wifi/scan (deferred: answered from poll() when the background scan is done)
+        _apiServer.registerMethod(APIMODULE_NAME, "wifi/scan", SCAN_METHOD,
+            [this](const JsonObject*) {
                 Serial.println("WIFIAPI: Exécution de GET wifi/scan");
-                _wifiManager.getAvailableNetworks(response);
-                
-                String debug;
-                serializeJson(response, debug);
-                Serial.printf("WIFIAPI: Réponse scan: %s\n", debug.c_str());
-                
-                return true;
-            })
-            .desc("Scan available WiFi networks")
-            .response("networks", {
-                {"ssid",        APIParamType::String},
-                {"rssi",        APIParamType::Integer},
-                {"encryption",  APIParamType::Integer}
-            })
-            .build()
+                APIPendingResponse pending;
+                if (_wifiManager.startScan()) {
+                    _scanWaiters.push_back(pending);    // Concurrent requests share the same scan
+                } else {
+                    pending.complete(false);
+                }
+                return pending;
+            }
         );
 
         // SET wifi/ap/config
-        _apiServer.registerMethod(APIMODULE_NAME, "wifi/ap/config",
-            APIMethodBuilder(APIMethodType::SET, [this](const JsonObject* args, JsonObject& response) {
+        _apiServer.registerMethod(APIMODULE_NAME, "wifi/ap/config", AP_CONFIG_METHOD,
+            [this](const JsonObject* args, JsonObject& response) {
                 bool success = _wifiManager.setAPConfigFromJson(*args);
                 response["success"] = success;
                 return true;
-            })
-            .desc("Configure Access Point")
-            .param("enabled",   APIParamType::Boolean)
-            .param("ssid",      APIParamType::String)
-            .param("password",  APIParamType::String)
-            .param("channel",   APIParamType::Integer)
-            .param("ip",        APIParamType::String, false)  // Optional
-            .param("gateway",   APIParamType::String, false)  // Optional
-            .param("subnet",    APIParamType::String, false)  // Optional
-            .response("success",APIParamType::Boolean)
-            .build()
+            }
         );
 
         // SET wifi/sta/config
-        _apiServer.registerMethod(APIMODULE_NAME, "wifi/sta/config",
-            APIMethodBuilder(APIMethodType::SET, [this](const JsonObject* args, JsonObject& response) {
+        _apiServer.registerMethod(APIMODULE_NAME, "wifi/sta/config", STA_CONFIG_METHOD,
+            [this](const JsonObject* args, JsonObject& response) {
                 bool success = _wifiManager.setSTAConfigFromJson(*args);
                 response["success"] = success;
                 return true;
-            })
-            .desc("Configure Station mode")
-            .param("enabled",   APIParamType::Boolean)
-            .param("ssid",      APIParamType::String)
-            .param("password",  APIParamType::String)
-            .param("dhcp",      APIParamType::Boolean)
-            .param("ip",        APIParamType::String, false)  // Optional
-            .param("gateway",   APIParamType::String, false)  // Optional
-            .param("subnet",    APIParamType::String, false)  // Optional
-            .response("success",APIParamType::Boolean)
-            .build()
+            }
         );
 
         // SET wifi/hostname
         _apiServer.registerMethod(APIMODULE_NAME, "wifi/hostname",
-            APIMethodBuilder(APIMethodType::SET, [this](const JsonObject* args, JsonObject& response) {
-                if (!(*args)["hostname"].is<const char*>()) {
-                    return false;
-                }
-                bool success = _wifiManager.setHostname((*args)["hostname"].as<const char*>());
+            APITypedMethodBuilder<HostnameArgs>(APIMethodType::SET, [this](const HostnameArgs& args, JsonObject& response) {
+                bool success = _wifiManager.setHostname(args.hostname);
                 response["success"] = success;
                 return true;
             })
             .desc("Set device hostname")
-            .param("hostname",        APIParamType::String)
+            .param("hostname",        &HostnameArgs::hostname)
             .response("success", APIParamType::Boolean)
+            .priority(APIPriority::Control)
             .build()
         );
 
         // EVT wifi/events
-        _apiServer.registerMethod(APIMODULE_NAME, "wifi/events",
-            APIMethodBuilder(APIMethodType::EVT)
-            .desc("WiFi status and configuration updates")
-            .response("status", {
-                {"ap", {
-                    {"enabled",     APIParamType::Boolean},
-                    {"connected",   APIParamType::Boolean},
-                    {"clients",     APIParamType::Integer},
-                    {"ip",          APIParamType::String},
-                    {"rssi",        APIParamType::Integer}
-                }},
-                {"sta", {
-                    {"enabled",     APIParamType::Boolean},
-                    {"connected",   APIParamType::Boolean},
-                    {"ip",          APIParamType::String},
-                    {"rssi",        APIParamType::Integer}
-                }}
-            })
-            .response("config", {
-                {"ap", {
-                    {"enabled",     APIParamType::Boolean},
-                    {"ssid",        APIParamType::String},
-                    {"password",    APIParamType::String},
-                    {"channel",     APIParamType::Integer},
-                    {"ip",          APIParamType::String},
-                    {"gateway",     APIParamType::String},
-                    {"subnet",      APIParamType::String}
-                }},
-            {"sta", {
-                    {"enabled",     APIParamType::Boolean},
-                    {"ssid",        APIParamType::String},
-                    {"password",    APIParamType::String},
-                    {"dhcp",        APIParamType::Boolean},
-                    {"ip",          APIParamType::String},
-                    {"gateway",     APIParamType::String},
-                    {"subnet",      APIParamType::String}
-                }}
-            })
-            .build()
-        );
+        _apiServer.registerMethod(APIMODULE_NAME, "wifi/events", EVENTS_METHOD);
         //@API_DOC_SECTION_END
     }
 
 
 
+    /**
+     * @brief Write a connection status with the GET wifi/status response writer
+     * @brief Same content as ConnectionStatus::toJson, in the declared field order
+     */
+    static void writeStatus(APIResponseWriter& writer, const char* key, const WiFiManager::ConnectionStatus& status) {
+        writer.beginObject(key);
+        writer.add("enabled", status.enabled);
+        writer.add("busy", status.busy);
+        writer.add("connected", status.connected);
+        writer.add("ip", status.ip.toString());
+        if (status.rssi) writer.add("rssi", status.rssi);
+        if (status.clients > 0) writer.add("clients", status.clients);  // Only if relevant (AP)
+        writer.endObject();
+    }
+
+    /**
+     * @brief Complete the pending GET wifi/scan requests once the scan is done
+     */
+    void pollScan() {
+        if (_scanWaiters.empty()) {
+            return;
+        }
+        int result = _wifiManager.scanComplete();
+        if (result == WIFI_SCAN_RUNNING) {
+            _apiServer.scheduler().arm(_scanTimer, SCAN_CHECK_INTERVAL);
+            return;
+        }
+
+        JsonDocument doc;
+        JsonObject networks = doc.to<JsonObject>();
+        if (result >= 0) {
+            _wifiManager.getScanResults(networks);
+            String debug;
+            serializeJson(networks, debug);
+            Serial.printf("WIFIAPI: Réponse scan: %s\n", debug.c_str());
+        }
+        for (APIPendingResponse& pending : _scanWaiters) {
+            if (result >= 0) {
+                pending.response().set(networks);
+            }
+            pending.complete(result >= 0);
+        }
+        _scanWaiters.clear();
+    }
+
     /**
      * @brief Send a notification to the API server
      * @param force Force the notification even if the state has not changed
      * @return True if the notification has been sent, false otherwise
      */
     bool sendNotification(bool force = false) {
-        unsigned long now = millis();
+        // Broadcast on change even if nobody listens: the APIServer keeps it as the latest
+        // value, replayed to the next client that subscribes
         StaticJsonDocument<1024> newState;
         JsonObject newStatus = newState["status"].to<JsonObject>();
         JsonObject newConfig = newState["config"].to<JsonObject>();
@@ -260,12 +313,14 @@ private:
         _wifiManager.getConfigToJson(newConfig);
 
         bool changed = (force || _previousState.isNull() || newState != _previousState);
-        bool heartbeatNeeded = (now - _lastHeartbeat >= HEARTBEAT_INTERVAL);
+        bool heartbeatNeeded = _heartbeatTimer.fired() && _apiServer.hasSubscribers("wifi/events");
         
         if (changed || heartbeatNeeded) {
             _apiServer.broadcast("wifi/events", newState.as<JsonObject>());
             _previousState = newState;
-            _lastHeartbeat = now;
+            if (changed && _heartbeatInterval) {
+                _apiServer.scheduler().every(_heartbeatTimer, _heartbeatInterval);    // Counted from the last event
+            }
             
             if (heartbeatNeeded && !changed) {
                 Serial.println("WIFIAPI: Envoi du heartbeat");
@@ -10,6 +10,7 @@
 #include "APIDocGenerator.h"
 
 #define GENERATE_API_DOC 0  // Mettre à 0 pour désactiver
+#define API_POLL_BUDGET_US 5000  // Temps alloué aux endpoints à chaque loop() (µs, 0 = illimité)
 
 // Proxy server for Serial port
 // #define Serial SerialAPIEndpoint::proxy
@@ -20,6 +21,8 @@ APIServer apiServer;                                        // APIServer instanc
 WiFiManagerAPI wifiManagerAPI(wifiManager, apiServer);      // WiFiManager API interface
 WebAPIEndpoint webServer(apiServer, 80);                    // Web server endpoint (HTTP+WS)
 // SerialAPIEndpoint serialAPI(apiServer);                  // Serial API endpoint
+// APIWorker apiWorker;                                     // Task running the API handlers (optional)
+APITimer wifiTimer;                                         // Wakes loop() for the WiFiManager status checks
 
 void setup() {
     Serial.begin(115200);
@@ -54,6 +57,7 @@ void setup() {
     //Add the web server endpoint to the API server
     apiServer.addEndpoint(&webServer);
     // apiServer.addEndpoint(&serialAPI);
+    // apiServer.setWorker(&apiWorker);
 
     // Initialize the WiFiManager
     if (!wifiManager.begin()) {
@@ -67,6 +71,12 @@ void setup() {
     // Start the API server
     apiServer.begin(); 
 
+    // Wake loop() for the WiFiManager checks and on WiFi events (connection, AP clients...)
+    apiServer.scheduler().every(wifiTimer, WiFiManager::POLL_INTERVAL);
+    WiFi.onEvent([](WiFiEvent_t event, WiFiEventInfo_t info) {
+        apiServer.scheduler().wake();
+    });
+
     Serial.println("System initialized");
     digitalWrite(LED_BUILTIN, LOW);
 
@@ -83,8 +93,13 @@ void setup() {
 }
 
 void loop() {
-    // Poll the WiFiManager, its API interface and the API server
-    wifiManager.poll();
+    // Sleep until a timer is due or work is posted (request, result, WiFi event), instead of spinning
+    apiServer.scheduler().waitForWork();
+
+    // Check the WiFi state when its timer is due, poll the API interface and the API server
+    if (wifiTimer.fired()) {
+        wifiManager.checkState();
+    }
     wifiManagerAPI.poll();
-    apiServer.poll(); 
+    apiServer.poll(API_POLL_BUDGET_US);
 }
\ No newline at end of file
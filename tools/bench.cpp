@@ -0,0 +1,504 @@
+#include <string>
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+//##############################################################################
+//                             Mock classes
+//##############################################################################
+
+// Mocks of the Arduino core (String, Serial, FS) live in deps/Arduino.h
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "../lib/APIServer/src/APIServer.h"
+
+
+//##############################################################################
+//                             Bench helpers
+//##############################################################################
+
+static constexpr size_t ITERATIONS = 200000;
+static const size_t METHOD_COUNTS[] = {10, 50, 100, 250, 500};
+
+// Prevents the compiler from optimizing away the measured work
+static volatile size_t benchSink = 0;
+
+/**
+ * @brief Run a callable ITERATIONS times and return the mean time per call (ns)
+ */
+template <typename F>
+double measureNs(F&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < ITERATIONS; i++) {
+        fn(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / ITERATIONS;
+}
+
+/**
+ * @brief Register `count` GET methods named bench/m<i> on the server
+ */
+void registerBenchMethods(APIServer& apiServer, size_t count) {
+    apiServer.registerModuleInfo("bench", "Benchmark methods");
+    for (size_t i = 0; i < count; i++) {
+        apiServer.registerMethod("bench", "bench/m" + String(i),
+            APIMethodBuilder(APIMethodType::GET, [](const JsonObject*, JsonObject& response) {
+                response["v"] = 1;
+                return true;
+            })
+            .desc("Benchmark method")
+            .response("v", APIParamType::Integer)
+            .build()
+        );
+    }
+}
+
+std::vector<String> makeUrls(size_t count) {
+    std::vector<String> urls;
+    for (size_t i = 0; i < count; i++) {
+        urls.push_back("/api/bench/m" + String(i));
+    }
+    return urls;
+}
+
+
+//##############################################################################
+//                     HTTP dispatch (WebAPIEndpoint routing)
+//##############################################################################
+
+/**
+ * @brief Compare the former per-route handler list with the single dispatcher of the /api/ paths
+ * @brief Former model: ESPAsyncWebServer walks one handler per route and compares the URL
+ * @brief Dispatcher model: the path is parsed once and resolved through the APIServer registry
+ */
+void benchHttpDispatch() {
+    std::cout << "\nHTTP dispatch latency (ns/request, handler included)\n";
+    printf("  %8s %14s %14s\n", "methods", "handler list", "dispatcher");
+
+    for (size_t count : METHOD_COUNTS) {
+        APIServer apiServer;
+        registerBenchMethods(apiServer, count);
+        apiServer.begin();
+        std::vector<String> urls = makeUrls(count);
+
+        // One handler per route, walked in registration order until canHandle() matches
+        std::vector<std::pair<String, APIMethodRef>> handlers;
+        for (size_t i = 0; i < count; i++) {
+            String path = urls[i].substring(5);
+            handlers.push_back({urls[i], apiServer.findMethod("http", path)});
+        }
+
+        JsonDocument doc;
+        double handlerListNs = measureNs([&](size_t i) {
+            const String& url = urls[i % count];
+            for (const auto& [uri, method] : handlers) {
+                if (uri == url) {
+                    JsonObject response = doc.to<JsonObject>();
+                    String path = url.substring(5);
+                    benchSink += apiServer.executeMethod("http", path, nullptr, response);
+                    break;
+                }
+            }
+        });
+
+        double dispatcherNs = measureNs([&](size_t i) {
+            const String& url = urls[i % count];
+            String path = url.substring(5);
+            APIMethodRef method = apiServer.findMethod("http", path);
+            if (method && method->type == APIMethodType::GET) {
+                JsonObject response = doc.to<JsonObject>();
+                benchSink += apiServer.executeMethod("http", path, nullptr, response);
+            }
+        });
+
+        printf("  %8zu %14.1f %14.1f\n", count, handlerListNs, dispatcherNs);
+    }
+}
+
+
+
+//##############################################################################
+//                  Route lookup (registry map vs route table)
+//##############################################################################
+
+/**
+ * @brief Compare a std::map<String, APIMethod> lookup with the frozen perfect-hash table
+ */
+void benchRouteLookup() {
+    std::cout << "\nRoute lookup latency (ns/lookup)\n";
+    printf("  %8s %14s %14s\n", "methods", "std::map", "route table");
+
+    for (size_t count : METHOD_COUNTS) {
+        APIServer apiServer;
+        registerBenchMethods(apiServer, count);
+        std::vector<String> paths;
+        for (const String& url : makeUrls(count)) {
+            paths.push_back(url.substring(5));
+        }
+
+        std::map<String, APIMethod> methods;
+        for (const String& path : paths) {
+            methods[path] = *apiServer.findMethod("http", path);
+        }
+        APIRouteTable<APIMethod> routes;
+        routes.build(methods);
+
+        double mapNs = measureNs([&](size_t i) {
+            benchSink += methods.find(paths[i % count]) != methods.end();
+        });
+
+        double tableNs = measureNs([&](size_t i) {
+            benchSink += routes.find(paths[i % count]) != nullptr;
+        });
+
+        printf("  %8zu %14.1f %14.1f\n", count, mapNs, tableNs);
+    }
+}
+
+
+
+//##############################################################################
+//               Parameter validation (presence only vs compiled plan)
+//##############################################################################
+
+/**
+ * @brief Former validateParams: presence of required top-level keys only
+ */
+bool validatePresence(const APIMethod& method, const JsonObject* args) {
+    if (!args && !method.requestParams.empty()) {
+        return false;
+    }
+    if (args) {
+        for (const auto& param : method.requestParams) {
+            if (param.required && (*args)[param.name].isNull()) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Deep validation interpreted from the schema tree (what the plan replaces)
+ */
+bool validateInterpreted(const std::vector<APIParam>& params, JsonObjectConst obj) {
+    for (const auto& param : params) {
+        JsonVariantConst value = obj[param.name];
+        if (value.isNull()) {
+            if (param.required) return false;
+            continue;
+        }
+        if (param.type == "boolean" && !value.is<bool>()) return false;
+        if (param.type == "integer" && !value.is<long>()) return false;
+        if (param.type == "number" && !value.is<float>()) return false;
+        if (param.type == "string" && !value.is<const char*>()) return false;
+        if (param.type == "object") {
+            if (!value.is<JsonObjectConst>()) return false;
+            if (!validateInterpreted(param.properties, value.as<JsonObjectConst>())) return false;
+        }
+        if (param.hasLimits) {
+            float v = param.type == "string" ? strlen(value.as<const char*>()) : value.as<float>();
+            if (v < param.min || v > param.max) return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Validation cost of a wifi/sta/config-like request, nested security object included
+ * @brief The presence-only check does less work: handlers then repeated the type checks
+ */
+void benchValidation() {
+    std::cout << "\nParameter validation latency (ns/request)\n";
+    printf("  %14s %14s %14s\n", "presence only", "interpreted", "compiled plan");
+
+    APIServer apiServer;
+    apiServer.registerMethod("bench", "bench/config",
+        APIMethodBuilder(APIMethodType::SET, [](const JsonObject*, JsonObject&) {
+            return true;
+        })
+        .param("enabled", APIParamType::Boolean)
+        .param("ssid", APIParamType::String, {1, 32})
+        .param("password", APIParamType::String, {8, 63})
+        .param("channel", APIParamType::Integer, {1, 13})
+        .param("dhcp", APIParamType::Boolean)
+        .param("ip", APIParamType::String, {7, 15}, false)
+        .param("security", {
+            {"type", APIParamType::String},
+            {"timeout", APIParamType::Number, {0, 60}},
+            {"certificates", {
+                {"ca", APIParamType::String},
+                {"client", APIParamType::String, false}
+            }}
+        })
+        .build()
+    );
+    APIMethodRef methodRef = apiServer.findMethod("http", "bench/config");
+    const APIMethod& method = *methodRef;
+
+    JsonDocument doc;
+    deserializeJson(doc, R"({"enabled":true,"ssid":"MyWiFi","password":"12345678","channel":6,)"
+                         R"("dhcp":false,"ip":"192.168.1.10","security":{"type":"WPA2-EAP",)"
+                         R"("timeout":5.5,"certificates":{"ca":"-----BEGIN CERTIFICATE-----"}}})");
+    JsonObject args = doc.as<JsonObject>();
+
+    double presenceNs = measureNs([&](size_t) {
+        benchSink += validatePresence(method, &args);
+    });
+    double interpretedNs = measureNs([&](size_t) {
+        benchSink += validateInterpreted(method.requestParams, args);
+    });
+    double planNs = measureNs([&](size_t) {
+        benchSink += method.validation.validate(&args);
+    });
+
+    printf("  %14.1f %14.1f %14.1f\n", presenceNs, interpretedNs, planNs);
+}
+
+
+
+//##############################################################################
+//              Response serialization (JsonDocument vs response writer)
+//##############################################################################
+
+/**
+ * @brief ArduinoJson allocator tracking the peak memory used by a JsonDocument
+ */
+class CountingAllocator : public ArduinoJson::Allocator {
+public:
+    size_t current = 0;
+    size_t peak = 0;
+
+    void* allocate(size_t size) override {
+        track(size);
+        size_t* block = static_cast<size_t*>(malloc(size + sizeof(size_t)));
+        *block = size;
+        return block + 1;
+    }
+    void deallocate(void* ptr) override {
+        size_t* block = static_cast<size_t*>(ptr) - 1;
+        current -= *block;
+        free(block);
+    }
+    void* reallocate(void* ptr, size_t newSize) override {
+        size_t* block = static_cast<size_t*>(ptr) - 1;
+        current -= *block;
+        track(newSize);
+        block = static_cast<size_t*>(realloc(block, newSize + sizeof(size_t)));
+        *block = newSize;
+        return block + 1;
+    }
+
+private:
+    void track(size_t size) {
+        current += size;
+        peak = std::max(peak, current);
+    }
+};
+
+/**
+ * @brief Serialize a wifi/status-like response: DOM + serializeJson vs direct writer
+ * @brief Memory = peak JsonDocument pool + output buffer (DOM), output buffer only (writer)
+ */
+void benchResponseWriter() {
+    std::cout << "\nResponse serialization (wifi/status-like, 2 nested objects)\n";
+    printf("  %14s %10s %10s\n", "", "ns/resp", "bytes");
+
+    auto schema = [](APIMethodBuilder builder) {
+        for (const char* key : {"ap", "sta"}) {
+            builder.response(key, {
+                {"enabled", APIParamType::Boolean},
+                {"busy", APIParamType::Boolean},
+                {"connected", APIParamType::Boolean},
+                {"ip", APIParamType::String},
+                {"rssi", APIParamType::Integer, false},
+                {"clients", APIParamType::Integer, false}
+            });
+        }
+        return builder.build();
+    };
+
+    APIServer apiServer;
+    apiServer.registerMethod("bench", "bench/dom", schema(
+        APIMethodBuilder(APIMethodType::GET, [](const JsonObject*, JsonObject& response) {
+            for (const char* key : {"ap", "sta"}) {
+                JsonObject status = response[key].to<JsonObject>();
+                status["enabled"] = true;
+                status["busy"] = false;
+                status["connected"] = true;
+                status["ip"] = String("192.168.1.100");
+                status["rssi"] = -65;
+                status["clients"] = 2;
+            }
+            return true;
+        })));
+    apiServer.registerMethod("bench", "bench/writer", schema(
+        APIMethodBuilder(APIMethodType::GET, [](const JsonObject*, APIResponseWriter& writer) {
+            for (const char* key : {"ap", "sta"}) {
+                writer.beginObject(key)
+                    .add("enabled", true)
+                    .add("busy", false)
+                    .add("connected", true)
+                    .add("ip", String("192.168.1.100"))
+                    .add("rssi", -65)
+                    .add("clients", 2)
+                    .endObject();
+            }
+            return true;
+        })));
+    APIMethodRef domMethodRef = apiServer.findMethod("http", "bench/dom");
+    const APIMethod& domMethod = *domMethodRef;
+    uint8_t http = apiServer.getProtocolId("http");
+
+    // Former path: fill a JsonDocument, then serialize it
+    CountingAllocator allocator;
+    size_t domBytes = 0;
+    double domNs = measureNs([&](size_t) {
+        JsonDocument doc(&allocator);
+        JsonObject response = doc.to<JsonObject>();
+        domMethod.handler(nullptr, response);
+        String output;
+        serializeJson(doc, output);
+        domBytes = allocator.peak + output.capacity();
+        benchSink += output.length();
+    });
+
+    size_t writerBytes = 0;
+    double writerNs = measureNs([&](size_t) {
+        String output;
+        apiServer.executeMethod(http, "bench/writer", nullptr, output);
+        writerBytes = output.capacity();
+        benchSink += output.length();
+    });
+
+    printf("  %14s %10.1f %10zu\n", "JsonDocument", domNs, domBytes);
+    printf("  %14s %10.1f %10zu\n", "writer", writerNs, writerBytes);
+}
+
+
+
+
+//##############################################################################
+//          Request execution (inline in the transport vs worker task)
+//##############################################################################
+
+/**
+ * @brief Closed-loop clients: each thread sends a request, waits for its response, repeats
+ * @brief "inline" runs the handler in the client thread (transport task, former model),
+ * @brief "worker" posts it to the APIWorker mailbox; a poller thread plays the loop task
+ * @brief (APIServer::poll) and hands the results back. Latency = request -> response.
+ */
+void benchWorker() {
+    static constexpr size_t REQUESTS_PER_CLIENT = 20000;
+    static const size_t CLIENT_COUNTS[] = {1, 2, 4, 8};
+
+    std::cout << "\nRequest execution (closed-loop clients, latency in us)\n";
+    printf("  %8s %8s %12s %8s %8s %8s %8s\n", "mode", "clients", "req/s", "p50", "p99", "p99.9", "max");
+
+    APIServer apiServer;
+    apiServer.registerMethod("bench", "bench/echo",
+        APIMethodBuilder(APIMethodType::SET, [](const JsonObject* args, JsonObject& response) {
+            response["v"] = (*args)["v"].as<int>();
+            return true;
+        })
+        .param("v", APIParamType::Integer)
+        .response("v", APIParamType::Integer)
+        .build()
+    );
+    uint8_t http = apiServer.getProtocolId("http");
+
+    auto report = [](const char* mode, size_t clients, std::vector<double>& latencies, double seconds) {
+        std::sort(latencies.begin(), latencies.end());
+        auto percentile = [&](double p) { return latencies[static_cast<size_t>(p * (latencies.size() - 1))]; };
+        printf("  %8s %8zu %12.0f %8.1f %8.1f %8.1f %8.1f\n", mode, clients, latencies.size() / seconds,
+               percentile(0.5), percentile(0.99), percentile(0.999), latencies.back());
+    };
+
+    auto run = [&](const char* mode, size_t clients, bool useWorker) {
+        std::vector<std::vector<double>> perClient(clients);
+        std::atomic<bool> polling{true};
+        std::thread poller([&]() {
+            while (polling.load()) {
+                apiServer.poll();
+                std::this_thread::yield();
+            }
+        });
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (size_t c = 0; c < clients; c++) {
+            threads.emplace_back([&, c]() {
+                JsonDocument request;
+                JsonObject args = request.to<JsonObject>();
+                std::atomic<bool> done{false};
+                perClient[c].reserve(REQUESTS_PER_CLIENT);
+                for (size_t i = 0; i < REQUESTS_PER_CLIENT; i++) {
+                    args["v"] = static_cast<int>(i);
+                    auto t0 = std::chrono::steady_clock::now();
+                    if (useWorker) {
+                        done.store(false);
+                        while (!apiServer.executeMethodAsync(http, "bench/echo", &args,
+                                [&](bool, const JsonObject& response) {
+                                    benchSink += response["v"].as<int>();
+                                    done.store(true, std::memory_order_release);
+                                })) {
+                            std::this_thread::yield();  // Mailbox full: retry
+                        }
+                        while (!done.load(std::memory_order_acquire)) {
+                            std::this_thread::yield();
+                        }
+                    } else {
+                        JsonDocument doc;
+                        JsonObject response = doc.to<JsonObject>();
+                        apiServer.executeMethod(http, "bench/echo", &args, response);
+                        benchSink += response["v"].as<int>();
+                    }
+                    auto t1 = std::chrono::steady_clock::now();
+                    perClient[c].push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        polling.store(false);
+        poller.join();
+
+        std::vector<double> latencies;
+        for (auto& client : perClient) {
+            latencies.insert(latencies.end(), client.begin(), client.end());
+        }
+        report(mode, clients, latencies, seconds);
+    };
+
+    for (size_t clients : CLIENT_COUNTS) {
+        run("inline", clients, false);
+    }
+
+    APIWorker worker;
+    apiServer.setWorker(&worker);
+    worker.begin();
+    for (size_t clients : CLIENT_COUNTS) {
+        run("worker", clients, true);
+    }
+    worker.end();
+    apiServer.setWorker(nullptr);
+}
+
+
+
+int main() {
+    Serial.muted = true;    // Library logs (endpoint start...) would cut the result tables
+    benchHttpDispatch();
+    benchRouteLookup();
+    benchValidation();
+    benchResponseWriter();
+    benchWorker();
+    return 0;
+}
@@ -1,6 +1,190 @@
 // Mock Arduino.h
+// Minimal host-side stand-ins for the Arduino core, so that the header-only
+// APIServer library can be compiled on a desktop (doc generator, benchmarks).
 #ifndef ARDUINO_H
 #define ARDUINO_H
 
+#include <string>
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include <cstdint>
+#include <cstdarg>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+#include <functional>
 
-#endif
\ No newline at end of file
+
+//##############################################################################
+//                                 String
+//##############################################################################
+
+class String : public std::string {
+public:
+    String() : std::string() {}
+    String(const char* str) : std::string(str ? str : "") {}
+    String(const std::string& str) : std::string(str) {}
+    String(char c) : std::string(1, c) {}
+    String(int value) : std::string(std::to_string(value)) {}
+    String(unsigned int value) : std::string(std::to_string(value)) {}
+    String(long value) : std::string(std::to_string(value)) {}
+    String(unsigned long value) : std::string(std::to_string(value)) {}
+    String(float value, int decimals = 2) : std::string(formatFloat(value, decimals)) {}
+    String(double value, int decimals = 2) : std::string(formatFloat(value, decimals)) {}
+
+    bool isEmpty() const { return empty(); }
+    unsigned int length() const { return static_cast<unsigned int>(size()); }
+
+    bool startsWith(const String& prefix) const { return compare(0, prefix.size(), prefix) == 0; }
+    bool endsWith(const String& suffix) const {
+        return size() >= suffix.size() && compare(size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    int indexOf(char c, unsigned int from = 0) const {
+        size_t pos = find(c, from);
+        return pos == npos ? -1 : static_cast<int>(pos);
+    }
+    int indexOf(const String& str, unsigned int from = 0) const {
+        size_t pos = find(str, from);
+        return pos == npos ? -1 : static_cast<int>(pos);
+    }
+
+    String substring(unsigned int from) const { return from >= size() ? String() : String(substr(from)); }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from > to) std::swap(from, to);
+        if (from >= size()) return String();
+        return String(substr(from, to - from));
+    }
+
+    void trim() {
+        size_t first = find_first_not_of(" \t\r\n");
+        size_t last = find_last_not_of(" \t\r\n");
+        *this = (first == npos) ? String() : String(substr(first, last - first + 1));
+    }
+
+    long toInt() const { return std::strtol(c_str(), nullptr, 10); }
+    float toFloat() const { return std::strtof(c_str(), nullptr); }
+
+    String operator+(const String& other) const {
+        return String(std::string(*this) + std::string(other));
+    }
+    String operator+(const char* other) const {
+        return String(std::string(*this) + other);
+    }
+    String operator+(char c) const {
+        return String(std::string(*this) + c);
+    }
+
+    // Writer interface, lets ArduinoJson serialize into a String like on the target
+    size_t write(uint8_t c) { push_back(static_cast<char>(c)); return 1; }
+    size_t write(const uint8_t* data, size_t n) { append(reinterpret_cast<const char*>(data), n); return n; }
+
+private:
+    static std::string formatFloat(double value, int decimals) {
+        char buffer[48];
+        snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+        return buffer;
+    }
+};
+
+inline String operator+(const char* lhs, const String& rhs) {
+    return String(std::string(lhs) + std::string(rhs));
+}
+
+
+//##############################################################################
+//                            Time & misc helpers
+//##############################################################################
+
+inline unsigned long millis() {
+    using namespace std::chrono;
+    static const auto start = steady_clock::now();
+    return static_cast<unsigned long>(duration_cast<milliseconds>(steady_clock::now() - start).count());
+}
+
+inline unsigned long micros() {
+    using namespace std::chrono;
+    static const auto start = steady_clock::now();
+    return static_cast<unsigned long>(duration_cast<microseconds>(steady_clock::now() - start).count());
+}
+
+inline void delay(unsigned long ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+inline void yield() {
+    std::this_thread::yield();
+}
+
+
+//##############################################################################
+//                              Serial & FS
+//##############################################################################
+
+using std::min;
+using std::max;
+
+class Stream {
+public:
+    virtual ~Stream() = default;
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual size_t write(uint8_t data) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+        for (size_t i = 0; i < size; i++) write(buffer[i]);
+        return size;
+    }
+    virtual void flush() {}
+};
+
+// Serial port: output goes to stdout (unless muted), no input
+class SerialMock : public Stream {
+public:
+    bool muted = false;     // Library logs silenced (benchmarks print their own tables)
+
+    void begin(unsigned long) {}
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    size_t write(uint8_t data) override { if (!muted) std::cout << static_cast<char>(data); return 1; }
+    using Stream::write;
+    void print(const char* str) { if (!muted) std::cout << str; }
+    void println(const char* str = "") { if (!muted) std::cout << str << std::endl; }
+    void println(const String& str) { if (!muted) std::cout << str << std::endl; }
+    void printf(const char* format, ...) {
+        if (muted) {
+            return;
+        }
+        va_list args;
+        va_start(args, format);
+        vprintf(format, args);
+        va_end(args);
+    }
+};
+
+namespace fs {
+    class File {
+    public:
+        bool print(const char*) { return true; }
+        bool println(const char*) { return true; }
+        void close() {}
+        operator bool() { return true; }
+        size_t write(uint8_t) { return 1; }
+        size_t write(const uint8_t*, size_t size) { return size; }
+    };
+
+    class FS {
+    public:
+        File open(const char*, const char*) { return File(); }
+    };
+}
+
+using fs::File;
+
+inline SerialMock Serial;
+inline fs::FS SPIFFS;
+
+#endif
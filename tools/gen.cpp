@@ -12,58 +12,8 @@
 //                             Mock classes
 //##############################################################################
 
-// Mock String class - DOIT ÊTRE DÉFINI AVANT APIServer.h
-class String : public std::string {
-public:
-    String() : std::string() {}
-    String(const char* str) : std::string(str) {}
-    String(const std::string& str) : std::string(str) {}
-    
-    bool isEmpty() const { return empty(); }
-    
-    String operator+(const String& other) const {
-        return String(std::string(*this) + std::string(other));
-    }
-    String operator+(const char* other) const {
-        return String(std::string(*this) + other);
-    }
-    
-    operator std::string() const { return std::string(*this); }
-};
-
-// Mock File System
-namespace fs {
-    class File {
-    public:
-        bool print(const char* str) { return true; }
-        bool println(const char* str) { return true; }
-        void close() {}
-        operator bool() { return true; }
-        size_t write(uint8_t c) { return 1; }
-        size_t write(const uint8_t* buf, size_t size) { return size; }
-    };
-
-    class FS {
-    public:
-        File open(const char* path, const char* mode) { return File(); }
-    };
-}
-
-// Mock Serial
-class SerialMock {
-public:
-    void println(const char* str) { std::cout << str << std::endl; }
-    void printf(const char* format, ...) {
-        va_list args;
-        va_start(args, format);
-        vprintf(format, args);
-        va_end(args);
-    }
-};
-
-// Variables globales mockées
-SerialMock Serial;
-fs::FS SPIFFS;
+// Mocks of the Arduino core (String, Serial, FS) live in deps/Arduino.h
+#include <Arduino.h>
 
 // APRÈS tous les mocks, on inclut APIServer
 #include <ArduinoJson.h>
@@ -94,33 +44,33 @@ void dumpRegisteredRoutes(APIServer& apiServer) {
     std::cout << "\nRegistered routes:\n";
     for (const auto& [path, method] : apiServer.getMethods()) {
         std::cout << "  " << path << " [" << toString(method.type) << "]" << std::endl;
-        if (!method.description.isEmpty()) {
-            std::cout << "    Description: " << std::string(method.description) << std::endl;
+        if (!method.getDescription().isEmpty()) {
+            std::cout << "    Description: " << std::string(method.getDescription()) << std::endl;
         }
     }
 }
 
 void dumpRegisteredRoutesAsJson(APIServer& apiServer) {
     JsonDocument doc;
-    JsonArray routes = doc.createNestedArray("routes");
+    JsonArray routes = doc["routes"].to<JsonArray>();
 
     for (const auto& [path, method] : apiServer.getMethods()) {
-        JsonObject routeObj = routes.createNestedObject();
+        JsonObject routeObj = routes.add<JsonObject>();
         routeObj["path"] = path;
         routeObj["type"] = toString(method.type);
-        routeObj["description"] = method.description;
+        routeObj["description"] = method.getDescription();
 
-        JsonArray requestParams = routeObj.createNestedArray("requestParams");
-        for (const auto& param : method.requestParams) {
-            JsonObject paramObj = requestParams.createNestedObject();
+        JsonArray requestParams = routeObj["requestParams"].to<JsonArray>();
+        for (const auto& param : method.getRequestParams()) {
+            JsonObject paramObj = requestParams.add<JsonObject>();
             paramObj["name"] = param.name;
             paramObj["type"] = param.type;
             paramObj["required"] = param.required;
         }
 
-        JsonArray responseParams = routeObj.createNestedArray("responseParams");
-        for (const auto& param : method.responseParams) {
-            JsonObject paramObj = responseParams.createNestedObject();
+        JsonArray responseParams = routeObj["responseParams"].to<JsonArray>();
+        for (const auto& param : method.getResponseParams()) {
+            JsonObject paramObj = responseParams.add<JsonObject>();
             paramObj["name"] = param.name;
             paramObj["type"] = param.type;
             paramObj["required"] = param.required;
@@ -221,14 +171,14 @@ void dumpRegisteredRoutesAsOpenAPI(APIServer& apiServer) {
         
         if (method.type != APIMethodType::EVT) {
             JsonObject operation = pathItem[httpMethod].to<JsonObject>();
-            operation["description"] = method.description;
+            operation["description"] = method.getDescription();
             JsonArray tags = operation["tags"].to<JsonArray>();
             tags.add("wifi");
 
             // Parameters pour GET
-            if (method.type == APIMethodType::GET && !method.requestParams.empty()) {
+            if (method.type == APIMethodType::GET && !method.getRequestParams().empty()) {
                 JsonArray parameters = operation["parameters"].to<JsonArray>();
-                for (const auto& param : method.requestParams) {
+                for (const auto& param : method.getRequestParams()) {
                     JsonObject parameter = parameters.add<JsonObject>();
                     parameter["name"] = param.name;
                     parameter["in"] = "query";
@@ -238,16 +188,18 @@ void dumpRegisteredRoutesAsOpenAPI(APIServer& apiServer) {
             }
 
             // RequestBody pour POST
-            if (method.type == APIMethodType::SET && !method.requestParams.empty()) {
+            if (method.type == APIMethodType::SET && !method.getRequestParams().empty()) {
                 JsonObject requestBody = operation["requestBody"].to<JsonObject>();
-                requestBody["required"] = true;
+                std::vector<APIParam> requestParams = method.getRequestParams();
+                requestBody["required"] = std::any_of(requestParams.begin(), requestParams.end(),
+                    [](const APIParam& param) { return param.required; });
                 JsonObject content = requestBody["content"]["application/json"].to<JsonObject>();
                 JsonObject schema = content["schema"].to<JsonObject>();
                 schema["type"] = "object";
                 JsonObject properties = schema["properties"].to<JsonObject>();
                 
                 JsonArray required = schema["required"].to<JsonArray>();
-                for (const auto& param : method.requestParams) {
+                for (const auto& param : method.getRequestParams()) {
                     JsonObject prop = properties[param.name].to<JsonObject>();
                     
                     // Si le paramètre a des propriétés, c'est un objet
@@ -277,7 +229,7 @@ void dumpRegisteredRoutesAsOpenAPI(APIServer& apiServer) {
             schema["type"] = "object";
             JsonObject properties = schema["properties"].to<JsonObject>();
             
-            for (const auto& param : method.responseParams) {
+            for (const auto& param : method.getResponseParams()) {
                 JsonObject prop = properties[param.name].to<JsonObject>();
                 
                 // Si le paramètre a des propriétés, c'est un objet
@@ -288,7 +240,7 @@ void dumpRegisteredRoutesAsOpenAPI(APIServer& apiServer) {
                         JsonObject subProp = subProps[subParam.name].to<JsonObject>();
                         subProp["type"] = toLowerCase(std::string(subParam.type));
                         if (subParam.required) {
-                            if (!prop.containsKey("required")) {
+                            if (!prop["required"].is<JsonArray>()) {
                                 prop["required"] = JsonArray();
                             }
                             prop["required"].add(subParam.name);
@@ -299,7 +251,7 @@ void dumpRegisteredRoutesAsOpenAPI(APIServer& apiServer) {
                 }
                 
                 if (param.required) {
-                    if (!schema.containsKey("required")) {
+                    if (!schema["required"].is<JsonArray>()) {
                         schema["required"] = JsonArray();
                     }
                     schema["required"].add(param.name);
@@ -349,7 +301,7 @@ void registerAllRoutes(APIServer& _apiServer) {
 
         // GET wifi/status
         _apiServer.registerMethod(APIMODULE_NAME, "wifi/status", 
-            APIMethodBuilder(APIMethodType::GET, [](const JsonObject* args, JsonObject& response) { return true; })
+            APIMethodBuilder(APIMethodType::GET, [](const JsonObject*, JsonObject&) { return true; })
             .desc("Get WiFi status")
             .response("ap", {
                 {"enabled", APIParamType::Boolean},
@@ -369,7 +321,7 @@ void registerAllRoutes(APIServer& _apiServer) {
 
         // GET wifi/config
         _apiServer.registerMethod(APIMODULE_NAME, "wifi/config",
-            APIMethodBuilder(APIMethodType::GET, [](const JsonObject* args, JsonObject& response) { return true; })
+            APIMethodBuilder(APIMethodType::GET, [](const JsonObject*, JsonObject&) { return true; })
             .desc("Get WiFi configuration")
             .response("ap", {
                 {"enabled",     APIParamType::Boolean},
@@ -394,7 +346,7 @@ void registerAllRoutes(APIServer& _apiServer) {
 
         // GET wifi/scan
         _apiServer.registerMethod(APIMODULE_NAME, "wifi/scan",
-            APIMethodBuilder(APIMethodType::GET, [](const JsonObject* args, JsonObject& response) { return true; })
+            APIMethodBuilder(APIMethodType::GET, [](const JsonObject*, JsonObject&) { return true; })
             .desc("Scan available WiFi networks")
             .response("networks", {
                 {"ssid",        APIParamType::String},
@@ -406,7 +358,7 @@ void registerAllRoutes(APIServer& _apiServer) {
 
         // SET wifi/ap/config
         _apiServer.registerMethod(APIMODULE_NAME, "wifi/ap/config",
-            APIMethodBuilder(APIMethodType::SET, [](const JsonObject* args, JsonObject& response) { return true; })
+            APIMethodBuilder(APIMethodType::SET, [](const JsonObject*, JsonObject&) { return true; })
             .desc("Configure Access Point")
             .param("enabled",   APIParamType::Boolean)
             .param("ssid",      APIParamType::String)
@@ -421,7 +373,7 @@ void registerAllRoutes(APIServer& _apiServer) {
 
         // SET wifi/sta/config
         _apiServer.registerMethod(APIMODULE_NAME, "wifi/sta/config",
-            APIMethodBuilder(APIMethodType::SET, [](const JsonObject* args, JsonObject& response) { return true; })
+            APIMethodBuilder(APIMethodType::SET, [](const JsonObject*, JsonObject&) { return true; })
             .desc("Configure Station mode")
             .param("enabled",   APIParamType::Boolean)
             .param("ssid",      APIParamType::String)
@@ -436,7 +388,7 @@ void registerAllRoutes(APIServer& _apiServer) {
 
         // SET wifi/hostname
         _apiServer.registerMethod(APIMODULE_NAME, "wifi/hostname",
-            APIMethodBuilder(APIMethodType::SET, [](const JsonObject* args, JsonObject& response) { return true; })
+            APIMethodBuilder(APIMethodType::SET, [](const JsonObject*, JsonObject&) { return true; })
             .desc("Set device hostname")
             .param("hostname",        APIParamType::String)
             .response("success", APIParamType::Boolean)
@@ -0,0 +1,37 @@
+#ifndef APITEST_H
+#define APITEST_H
+
+#include <cstdio>
+
+// Mocks of the Arduino core (String, Serial, millis...) live in ../deps/Arduino.h
+#include <Arduino.h>
+
+/**
+ * @brief Minimal host test helpers: one executable per component, run by ctest
+ * @brief A failed CHECK prints its location and the test goes on; the executable
+ * @brief returns the number of failures (0 = passed).
+ */
+static int apiTestFailures = 0;
+
+#define CHECK(condition) do { \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            apiTestFailures++; \
+        } \
+    } while (0)
+
+#define RUN_TEST(test) do { \
+        printf("[ RUN  ] %s\n", #test); \
+        int failuresBefore = apiTestFailures; \
+        test(); \
+        printf("[ %s ] %s\n", apiTestFailures == failuresBefore ? " OK " : "FAIL", #test); \
+    } while (0)
+
+inline int testResult() {
+    if (apiTestFailures) {
+        printf("%d check(s) failed\n", apiTestFailures);
+    }
+    return apiTestFailures;
+}
+
+#endif // APITEST_H
@@ -0,0 +1,145 @@
+#include <vector>
+
+#include "APITest.h"
+#include <ArduinoJson.h>
+#include "../../lib/APIServer/src/APIEvent.h"
+
+
+//##############################################################################
+//                             Helpers
+//##############################################################################
+
+APIEventRef makeEvent(const String& name, APIPriority priority) {
+    JsonDocument doc;
+    return std::make_shared<APIEvent>(name, doc.to<JsonObject>(), priority);
+}
+
+String names(const std::vector<APIEventRef>& events) {
+    String result;
+    for (const auto& event : events) {
+        result += event->name();
+    }
+    return result;
+}
+
+
+//##############################################################################
+//                             Order of sending
+//##############################################################################
+
+void testFifoWithinClass() {
+    APIEventQueue<8> queue;
+    for (const char* name : {"a", "b", "c"}) {
+        CHECK(queue.push(makeEvent(name, APIPriority::Interactive)));
+    }
+    std::vector<APIEventRef> events;
+    CHECK(queue.take(events) == 3);
+    CHECK(names(events) == "abc");
+    CHECK(queue.empty());
+    CHECK(queue.take() == nullptr);
+}
+
+void testWeightedRoundRobin() {
+    APIEventQueue<8> queue;
+    for (int i = 0; i < 8; i++) {
+        queue.push(makeEvent("C", APIPriority::Control));
+        queue.push(makeEvent("I", APIPriority::Interactive));
+        queue.push(makeEvent("T", APIPriority::Telemetry));
+    }
+    std::vector<APIEventRef> events;
+    CHECK(queue.take(events) == 24);
+    // Weights 4/2/1 while all classes have events, then the remaining ones in turn
+    CHECK(names(events) == "CCCCIIT" "CCCCIIT" "IIT" "IIT" "TTTT");
+}
+
+void testTelemetryNotStarved() {
+    APIEventQueue<16> queue;
+    for (int i = 0; i < 16; i++) {
+        queue.push(makeEvent("C", APIPriority::Control));
+    }
+    queue.push(makeEvent("T", APIPriority::Telemetry));
+    std::vector<APIEventRef> events;
+    queue.take(events, 6);
+    CHECK(names(events) == "CCCCTC");    // Served in the first round despite the control flood
+}
+
+void testTakeLimit() {
+    APIEventQueue<8> queue;
+    for (int i = 0; i < 5; i++) {
+        queue.push(makeEvent("T", APIPriority::Telemetry));
+    }
+    std::vector<APIEventRef> events;
+    CHECK(queue.take(events, 2) == 2);
+    CHECK(queue.size() == 3);
+    CHECK(queue.take(events, 10) == 3);
+    CHECK(events.size() == 5);
+}
+
+void testUnknownPriority() {
+    APIEventQueue<4> queue;
+    queue.push(makeEvent("x", static_cast<APIPriority>(7)));
+    CHECK(queue.getStats(APIPriority::Interactive).depth == 1);
+}
+
+
+//##############################################################################
+//                             Eviction
+//##############################################################################
+
+void testOldestDroppedWhenFull() {
+    APIEventQueue<4> queue;
+    for (const char* name : {"1", "2", "3", "4"}) {
+        CHECK(queue.push(makeEvent(name, APIPriority::Telemetry)));
+    }
+    CHECK(!queue.push(makeEvent("5", APIPriority::Telemetry)));
+    CHECK(!queue.push(makeEvent("6", APIPriority::Telemetry)));
+    CHECK(queue.size() == 4);
+
+    std::vector<APIEventRef> events;
+    queue.take(events);
+    CHECK(names(events) == "3456");
+
+    APIQueueStats stats = queue.getStats(APIPriority::Telemetry);
+    CHECK(stats.rejected == 2);
+    CHECK(stats.served == 4);
+    CHECK(stats.maxDepth == 4);
+    CHECK(stats.depth == 0);
+}
+
+void testFloodOnlyDropsItsClass() {
+    APIEventQueue<4> queue;
+    queue.push(makeEvent("c", APIPriority::Control));
+    for (int i = 0; i < 10; i++) {
+        queue.push(makeEvent("t", APIPriority::Telemetry));
+    }
+    CHECK(queue.getStats(APIPriority::Control).rejected == 0);
+    CHECK(queue.getStats(APIPriority::Telemetry).rejected == 6);
+    APIEventRef first = queue.take();
+    CHECK(first && first->name() == "c");
+}
+
+void testEventsReleased() {
+    APIEventQueue<2> queue;
+    APIEventRef event = makeEvent("e", APIPriority::Interactive);
+    queue.push(event);
+    queue.push(event);
+    queue.push(event);      // Drops the first reference
+    CHECK(event.use_count() == 3);
+    std::vector<APIEventRef> events;
+    queue.take(events);
+    events.clear();
+    CHECK(event.use_count() == 1);      // The queue keeps no reference once taken
+}
+
+
+int main() {
+    RUN_TEST(testFifoWithinClass);
+    RUN_TEST(testWeightedRoundRobin);
+    RUN_TEST(testTelemetryNotStarved);
+    RUN_TEST(testTakeLimit);
+    RUN_TEST(testUnknownPriority);
+    RUN_TEST(testOldestDroppedWhenFull);
+    RUN_TEST(testFloodOnlyDropsItsClass);
+    RUN_TEST(testEventsReleased);
+    return testResult();
+}
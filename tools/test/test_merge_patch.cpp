@@ -0,0 +1,102 @@
+#include "APITest.h"
+#include <ArduinoJson.h>
+#include "../../lib/APIServer/src/APIMergePatch.h"
+
+
+//##############################################################################
+//                             Helpers
+//##############################################################################
+
+/**
+ * @brief Diff two JSON values, apply the patch to the first one and check the result
+ * @param expectedPatch Expected patch (JSON), or nullptr to skip that check
+ * @return True if applying the patch gives the second value
+ */
+bool roundTrip(const char* fromJson, const char* toJson, const char* expectedPatch = nullptr) {
+    JsonDocument from, to, patch;
+    deserializeJson(from, fromJson);
+    deserializeJson(to, toJson);
+    APIMergePatch::diff(from.as<JsonObjectConst>(), to.as<JsonObjectConst>(), patch.to<JsonObject>());
+
+    if (expectedPatch) {
+        JsonDocument expected;
+        deserializeJson(expected, expectedPatch);
+        if (patch.as<JsonVariantConst>() != expected.as<JsonVariantConst>()) {
+            String actual;
+            serializeJson(patch, actual);
+            fprintf(stderr, "patch %s, expected %s\n", actual.c_str(), expectedPatch);
+            return false;
+        }
+    }
+
+    APIMergePatch::apply(from.as<JsonObject>(), patch.as<JsonObjectConst>());
+    return from.as<JsonVariantConst>() == to.as<JsonVariantConst>();
+}
+
+
+//##############################################################################
+//                             Diff and apply
+//##############################################################################
+
+void testEqualValues() {
+    CHECK(roundTrip("{}", "{}", "{}"));
+    CHECK(roundTrip("{\"a\":1,\"b\":{\"c\":\"x\"}}", "{\"a\":1,\"b\":{\"c\":\"x\"}}", "{}"));
+}
+
+void testScalarChanges() {
+    CHECK(roundTrip("{\"rssi\":-60,\"ssid\":\"home\"}", "{\"rssi\":-61,\"ssid\":\"home\"}", "{\"rssi\":-61}"));
+    CHECK(roundTrip("{\"on\":false}", "{\"on\":true}", "{\"on\":true}"));
+    CHECK(roundTrip("{\"v\":1}", "{\"v\":\"1\"}", "{\"v\":\"1\"}"));    // Type change
+}
+
+void testAddedAndRemovedMembers() {
+    CHECK(roundTrip("{\"a\":1}", "{\"a\":1,\"b\":2}", "{\"b\":2}"));
+    CHECK(roundTrip("{\"a\":1,\"b\":2}", "{\"a\":1}", "{\"b\":null}"));
+    CHECK(roundTrip("{\"a\":{\"x\":1}}", "{}", "{\"a\":null}"));
+}
+
+void testNestedObjects() {
+    CHECK(roundTrip("{\"net\":{\"ip\":\"10.0.0.2\",\"mask\":\"255.0.0.0\"},\"up\":1}",
+                    "{\"net\":{\"ip\":\"10.0.0.3\",\"mask\":\"255.0.0.0\"},\"up\":1}",
+                    "{\"net\":{\"ip\":\"10.0.0.3\"}}"));
+    CHECK(roundTrip("{\"a\":{\"b\":{\"c\":1,\"d\":2}}}", "{\"a\":{\"b\":{\"c\":1}}}", "{\"a\":{\"b\":{\"d\":null}}}"));
+    CHECK(roundTrip("{\"a\":1}", "{\"a\":{\"b\":1}}", "{\"a\":{\"b\":1}}"));    // Scalar -> object
+    CHECK(roundTrip("{\"a\":{\"b\":1}}", "{\"a\":1}", "{\"a\":1}"));            // Object -> scalar
+}
+
+void testArraysReplaced() {
+    CHECK(roundTrip("{\"list\":[1,2,3]}", "{\"list\":[1,2,4]}", "{\"list\":[1,2,4]}"));
+    CHECK(roundTrip("{\"list\":[1,2,3]}", "{\"list\":[1,2,3]}", "{}"));
+    CHECK(roundTrip("{\"list\":[{\"a\":1}]}", "{\"list\":[]}", "{\"list\":[]}"));
+}
+
+void testSuccessiveUpdates() {
+    // A client applying each patch in turn follows the server's values
+    const char* values[] = {
+        "{\"ssid\":\"home\",\"rssi\":-60,\"ip\":{\"v4\":\"10.0.0.2\"}}",
+        "{\"ssid\":\"home\",\"rssi\":-58,\"ip\":{\"v4\":\"10.0.0.2\"}}",
+        "{\"ssid\":\"home\",\"rssi\":-58}",
+        "{\"ssid\":\"office\",\"rssi\":-70,\"ip\":{\"v4\":\"192.168.1.9\",\"v6\":\"fe80::1\"}}",
+    };
+    JsonDocument client;
+    deserializeJson(client, values[0]);
+    for (size_t i = 1; i < sizeof(values) / sizeof(values[0]); i++) {
+        JsonDocument previous, current, patch;
+        deserializeJson(previous, values[i - 1]);
+        deserializeJson(current, values[i]);
+        APIMergePatch::diff(previous.as<JsonObjectConst>(), current.as<JsonObjectConst>(), patch.to<JsonObject>());
+        APIMergePatch::apply(client.as<JsonObject>(), patch.as<JsonObjectConst>());
+        CHECK(client.as<JsonVariantConst>() == current.as<JsonVariantConst>());
+    }
+}
+
+
+int main() {
+    RUN_TEST(testEqualValues);
+    RUN_TEST(testScalarChanges);
+    RUN_TEST(testAddedAndRemovedMembers);
+    RUN_TEST(testNestedObjects);
+    RUN_TEST(testArraysReplaced);
+    RUN_TEST(testSuccessiveUpdates);
+    return testResult();
+}
@@ -0,0 +1,158 @@
+#include "APITest.h"
+#include "../../lib/APIServer/src/APIResponseCache.h"
+
+
+//##############################################################################
+//                             Hits, misses and TTL
+//##############################################################################
+
+void testMissThenHit() {
+    APIResponseCache cache;
+    cache.configure("wifi/status", true, {});
+    String output;
+    uint32_t generation = 0;
+    CHECK(!cache.get("wifi/status", 0, output, generation));
+    cache.put("wifi/status", "{\"connected\":true}", generation);
+
+    output = "prefix:";
+    CHECK(cache.get("wifi/status", 0, output, generation));
+    CHECK(output == "prefix:{\"connected\":true}");     // Appended
+
+    APIResponseCache::Stats stats = cache.getStats("wifi/status");
+    CHECK(stats.hits == 1);
+    CHECK(stats.misses == 1);
+}
+
+void testUnconfiguredPath() {
+    APIResponseCache cache;
+    String output;
+    uint32_t generation = 0;
+    CHECK(!cache.get("wifi/status", 0, output, generation));
+    cache.put("wifi/status", "{}", generation);     // Ignored: not cached
+    CHECK(!cache.get("wifi/status", 0, output, generation));
+    CHECK(output.isEmpty());
+}
+
+void testTTLExpiry() {
+    APIResponseCache cache;
+    cache.configure("sensor/read", true, {});
+    String output;
+    uint32_t generation = 0;
+    cache.get("sensor/read", 30, output, generation);
+    cache.put("sensor/read", "{\"t\":21}", generation);
+    CHECK(cache.get("sensor/read", 30, output, generation));
+
+    delay(40);
+    output = String();
+    CHECK(!cache.get("sensor/read", 30, output, generation));
+    CHECK(output.isEmpty());
+    CHECK(cache.getStats("sensor/read").misses == 2);
+}
+
+void testNoTTL() {
+    APIResponseCache cache;
+    cache.configure("sys/info", true, {});
+    String output;
+    uint32_t generation = 0;
+    cache.get("sys/info", 0, output, generation);
+    cache.put("sys/info", "{}", generation);
+    delay(20);
+    CHECK(cache.get("sys/info", 0, output, generation));    // 0 = until invalidated
+}
+
+void testPeekDoesNotCountMiss() {
+    APIResponseCache cache;
+    cache.configure("wifi/status", true, {});
+    String output;
+    CHECK(!cache.peek("wifi/status", 0, output));
+    CHECK(cache.getStats("wifi/status").misses == 0);
+}
+
+
+//##############################################################################
+//                             Invalidation and generations
+//##############################################################################
+
+void testInvalidateByPath() {
+    APIResponseCache cache;
+    cache.configure("wifi/status", true, {});
+    String output;
+    uint32_t generation = 0;
+    cache.get("wifi/status", 0, output, generation);
+    cache.put("wifi/status", "{}", generation);
+
+    cache.invalidate(String("wifi/status"));
+    CHECK(!cache.get("wifi/status", 0, output, generation));
+    CHECK(cache.getStats("wifi/status").invalidations == 1);
+}
+
+void testInvalidateByKey() {
+    APIResponseCache cache;
+    cache.configure("wifi/status", true, {"wifi"});
+    cache.configure("wifi/config", true, {"wifi", "config"});
+    cache.configure("sys/info", true, {"config"});
+    String output;
+    uint32_t generation = 0;
+    for (const char* path : {"wifi/status", "wifi/config", "sys/info"}) {
+        cache.get(path, 0, output, generation);
+        cache.put(path, "{}", generation);
+    }
+
+    cache.invalidate("wifi");   // Flash key, compared in place
+    CHECK(!cache.peek("wifi/status", 0, output));
+    CHECK(!cache.peek("wifi/config", 0, output));
+    CHECK(cache.peek("sys/info", 0, output));       // Does not depend on it
+
+    APIResponseCache::Stats total = cache.getStats();
+    CHECK(total.invalidations == 2);
+}
+
+void testStalePutDropped() {
+    APIResponseCache cache;
+    cache.configure("wifi/status", true, {"wifi"});
+    String output;
+    uint32_t generation = 0;
+    CHECK(!cache.get("wifi/status", 0, output, generation));
+    cache.invalidate("wifi");       // State changed while the handler ran
+    cache.put("wifi/status", "{\"old\":true}", generation);
+    CHECK(!cache.peek("wifi/status", 0, output));
+
+    CHECK(!cache.get("wifi/status", 0, output, generation));
+    cache.put("wifi/status", "{\"new\":true}", generation);
+    output = String();
+    CHECK(cache.peek("wifi/status", 0, output));
+    CHECK(output == "{\"new\":true}");
+}
+
+void testReconfigure() {
+    APIResponseCache cache;
+    cache.configure("wifi/status", true, {});
+    String output;
+    uint32_t generation = 0;
+    cache.get("wifi/status", 0, output, generation);
+    cache.put("wifi/status", "{}", generation);
+
+    cache.configure("wifi/status", true, {"wifi"});     // Registered again: entry dropped
+    CHECK(!cache.peek("wifi/status", 0, output));
+
+    cache.get("wifi/status", 0, output, generation);
+    cache.put("wifi/status", "{}", generation);
+    cache.configure("wifi/status", false, {});          // Cache disabled
+    CHECK(!cache.peek("wifi/status", 0, output));
+    cache.put("wifi/status", "{}", generation);
+    CHECK(!cache.peek("wifi/status", 0, output));
+}
+
+
+int main() {
+    RUN_TEST(testMissThenHit);
+    RUN_TEST(testUnconfiguredPath);
+    RUN_TEST(testTTLExpiry);
+    RUN_TEST(testNoTTL);
+    RUN_TEST(testPeekDoesNotCountMiss);
+    RUN_TEST(testInvalidateByPath);
+    RUN_TEST(testInvalidateByKey);
+    RUN_TEST(testStalePutDropped);
+    RUN_TEST(testReconfigure);
+    return testResult();
+}
@@ -0,0 +1,99 @@
+#include <map>
+#include <memory>
+#include <string>
+
+#include "APITest.h"
+#include "../../lib/APIServer/src/APIRouteTable.h"
+
+
+//##############################################################################
+//                             Lookups
+//##############################################################################
+
+void testEveryKeyFound() {
+    for (size_t count : {1, 2, 10, 100, 500}) {
+        std::map<String, int> entries;
+        for (size_t i = 0; i < count; i++) {
+            entries["module" + String(i % 7) + "/method" + String(i)] = static_cast<int>(i);
+        }
+        APIRouteTable<int> table;
+        CHECK(table.build(entries));
+        CHECK(table.isBuilt());
+        for (const auto& [key, value] : entries) {
+            const int* found = table.find(key);
+            CHECK(found == &value);     // Points to the map entry, not to a copy
+        }
+    }
+}
+
+void testUnknownKeys() {
+    std::map<String, int> entries = {{"wifi/status", 1}, {"wifi/config", 2}, {"sys/metrics", 3}};
+    APIRouteTable<int> table;
+    CHECK(table.build(entries));
+    CHECK(table.find("wifi/scan") == nullptr);
+    CHECK(table.find("") == nullptr);
+    CHECK(table.find("wifi/statu") == nullptr);     // Prefix of a key
+    CHECK(table.find("wifi/statuss") == nullptr);   // Key as prefix
+    CHECK(table.find("WIFI/STATUS") == nullptr);
+}
+
+void testKeyNotNullTerminated() {
+    std::map<String, int> entries = {{"wifi/status", 1}, {"wifi", 2}};
+    APIRouteTable<int> table;
+    CHECK(table.build(entries));
+    const char* path = "wifi/status?verbose=1";     // Path followed by a query string
+    const int* found = table.find(path, 11);
+    CHECK(found && *found == 1);
+    found = table.find(path, 4);
+    CHECK(found && *found == 2);
+    CHECK(table.find(path, 5) == nullptr);
+}
+
+void testSharedValues() {
+    std::map<String, std::shared_ptr<const int>> entries;
+    entries["a"] = std::make_shared<int>(1);
+    entries["b"] = std::make_shared<int>(2);
+    APIRouteTable<int> table;
+    CHECK(table.build(entries));
+    CHECK(table.find("a") == entries["a"].get());   // Pointee of the shared value
+    CHECK(table.find("b") == entries["b"].get());
+}
+
+
+//##############################################################################
+//                             Build and clear
+//##############################################################################
+
+void testEmptyTable() {
+    std::map<String, int> entries;
+    APIRouteTable<int> table;
+    CHECK(!table.isBuilt());
+    CHECK(table.build(entries));
+    CHECK(table.isBuilt());
+    CHECK(table.find("anything") == nullptr);
+}
+
+void testRebuildAndClear() {
+    std::map<String, int> entries = {{"a/1", 1}};
+    APIRouteTable<int> table;
+    CHECK(table.build(entries));
+    entries["a/2"] = 2;
+    CHECK(table.build(entries));    // Rebuilt from the modified map
+    const int* found = table.find("a/2");
+    CHECK(found && *found == 2);
+
+    table.clear();
+    CHECK(!table.isBuilt());
+    CHECK(table.find("a/1") == nullptr);
+}
+
+
+int main() {
+    RUN_TEST(testEveryKeyFound);
+    RUN_TEST(testUnknownKeys);
+    RUN_TEST(testKeyNotNullTerminated);
+    RUN_TEST(testSharedValues);
+    RUN_TEST(testEmptyTable);
+    RUN_TEST(testRebuildAndClear);
+    return testResult();
+}
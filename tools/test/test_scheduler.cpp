@@ -0,0 +1,186 @@
+#include <thread>
+
+#include "APITest.h"
+#include "../../lib/APIServer/src/APIScheduler.h"
+
+// Timings run on the host clock: checks leave a margin of a few ticks
+static constexpr unsigned long MARGIN_MS = 3 * APIScheduler::TICK_MS;
+
+
+//##############################################################################
+//                             Timers
+//##############################################################################
+
+void testOneShot() {
+    APIScheduler scheduler;
+    APITimer timer;
+    scheduler.schedule(timer, 20);
+    CHECK(timer.isArmed());
+    CHECK(scheduler.nextDelay() <= 20 + APIScheduler::TICK_MS);
+    scheduler.advance();
+    CHECK(!timer.fired());
+
+    delay(20 + MARGIN_MS);
+    CHECK(scheduler.advance() == 1);
+    CHECK(timer.fired());
+    CHECK(!timer.fired());      // Reported once
+    CHECK(!timer.isArmed());
+    CHECK(scheduler.nextDelay() == APIScheduler::FOREVER);
+}
+
+void testCancel() {
+    APIScheduler scheduler;
+    APITimer timer;
+    scheduler.schedule(timer, 10);
+    scheduler.cancel(timer);
+    CHECK(!timer.isArmed());
+    delay(10 + MARGIN_MS);
+    CHECK(scheduler.advance() == 0);
+    CHECK(!timer.fired());
+    CHECK(scheduler.nextDelay() == APIScheduler::FOREVER);
+}
+
+void testScheduleReplacesArmKeepsEarlier() {
+    APIScheduler scheduler;
+    APITimer timer;
+    scheduler.arm(timer, 10);
+    scheduler.arm(timer, 200);      // Window already open: earlier deadline kept
+    CHECK(scheduler.nextDelay() <= 10 + APIScheduler::TICK_MS);
+
+    scheduler.schedule(timer, 200); // Replaced
+    CHECK(scheduler.nextDelay() > 100);
+
+    scheduler.arm(timer, 10);       // Earlier than the current deadline
+    CHECK(scheduler.nextDelay() <= 10 + APIScheduler::TICK_MS);
+}
+
+void testPeriodic() {
+    APIScheduler scheduler;
+    APITimer timer;
+    scheduler.every(timer, 10);
+    int fired = 0;
+    unsigned long start = millis();
+    while (millis() - start < 60) {
+        scheduler.advance();
+        fired += timer.fired();
+        delay(1);
+    }
+    CHECK(fired >= 3);
+    CHECK(fired <= 7);
+    CHECK(timer.isArmed());     // Re-armed by the scheduler
+}
+
+void testBeyondOneTurn() {
+    // One wheel turn is WHEEL_SLOTS ticks: later deadlines stay linked until their turn
+    unsigned long turnMs = APIScheduler::WHEEL_SLOTS * APIScheduler::TICK_MS;
+    APIScheduler scheduler;
+    APITimer timer;
+    scheduler.schedule(timer, turnMs + 60);
+    delay(turnMs + 10);
+    scheduler.advance();
+    CHECK(!timer.fired());
+    CHECK(timer.isArmed());
+
+    delay(50 + MARGIN_MS);
+    scheduler.advance();
+    CHECK(timer.fired());
+}
+
+void testTimersInSameSlot() {
+    APIScheduler scheduler;
+    APITimer first, second, third;
+    scheduler.schedule(first, 10);
+    scheduler.schedule(second, 10);
+    scheduler.schedule(third, 10);
+    scheduler.cancel(second);       // Unlinked from the middle of the slot
+    delay(10 + MARGIN_MS);
+    CHECK(scheduler.advance() == 2);
+    CHECK(first.fired());
+    CHECK(!second.fired());
+    CHECK(third.fired());
+}
+
+void testTimerDestroyedWhileArmed() {
+    APIScheduler scheduler;
+    {
+        APITimer timer;
+        scheduler.schedule(timer, 10);
+    }
+    CHECK(scheduler.nextDelay() == APIScheduler::FOREVER);
+    delay(10 + MARGIN_MS);
+    CHECK(scheduler.advance() == 0);
+}
+
+
+//##############################################################################
+//                             Sleep of the loop
+//##############################################################################
+
+void testWaitUntilDeadline() {
+    APIScheduler scheduler;
+    APITimer timer;
+    scheduler.schedule(timer, 20);
+    unsigned long start = millis();
+    scheduler.waitForWork();
+    unsigned long elapsed = millis() - start;
+    CHECK(timer.fired());
+    CHECK(elapsed + APIScheduler::TICK_MS >= 20);
+    CHECK(elapsed < 200);
+}
+
+void testWaitBoundedByMaxWait() {
+    APIScheduler scheduler;
+    unsigned long start = millis();
+    scheduler.waitForWork(20);
+    unsigned long elapsed = millis() - start;
+    CHECK(elapsed >= 15);
+    CHECK(elapsed < 200);
+}
+
+void testWakeFromAnotherTask() {
+    APIScheduler scheduler;
+    std::thread task([&scheduler]() {
+        delay(20);
+        scheduler.wake();
+    });
+    unsigned long start = millis();
+    scheduler.waitForWork();    // No timer: sleeps until the wake
+    unsigned long elapsed = millis() - start;
+    task.join();
+    CHECK(elapsed < 500);
+    CHECK(scheduler.getStats().wakeups == 1);
+}
+
+void testTimerArmedDuringSleep() {
+    APIScheduler scheduler;
+    APITimer late, early;
+    scheduler.schedule(late, 1000);
+    std::thread task([&scheduler, &early]() {
+        delay(10);
+        scheduler.schedule(early, 10);      // Earlier than the sleep deadline: ends it
+    });
+    unsigned long start = millis();
+    while (!early.fired() && millis() - start < 1000) {
+        scheduler.waitForWork();
+    }
+    unsigned long elapsed = millis() - start;
+    task.join();
+    CHECK(elapsed < 500);
+    CHECK(!late.fired());
+}
+
+
+int main() {
+    RUN_TEST(testOneShot);
+    RUN_TEST(testCancel);
+    RUN_TEST(testScheduleReplacesArmKeepsEarlier);
+    RUN_TEST(testPeriodic);
+    RUN_TEST(testBeyondOneTurn);
+    RUN_TEST(testTimersInSameSlot);
+    RUN_TEST(testTimerDestroyedWhileArmed);
+    RUN_TEST(testWaitUntilDeadline);
+    RUN_TEST(testWaitBoundedByMaxWait);
+    RUN_TEST(testWakeFromAnotherTask);
+    RUN_TEST(testTimerArmedDuringSleep);
+    return testResult();
+}
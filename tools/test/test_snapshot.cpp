@@ -0,0 +1,126 @@
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "APITest.h"
+#include "../../lib/APIServer/src/APISnapshot.h"
+
+// Counts the live versions: a retired version must be deleted once, and not before its readers
+struct Value {
+    static std::atomic<int> live;
+    int data = 0;
+    Value() { live++; }
+    Value(const Value& other) : data(other.data) { live++; }
+    ~Value() { live--; }
+};
+std::atomic<int> Value::live{0};
+
+
+//##############################################################################
+//                             Publication and reclaim
+//##############################################################################
+
+void testUpdateWithoutReaders() {
+    {
+        APISnapshot<Value> snapshot;
+        snapshot.update([](Value& value) { value.data = 1; });
+        CHECK(snapshot.read()->data == 1);
+        CHECK(snapshot.version() == 1);
+        CHECK(snapshot.reclaim() == 0);     // Freed by the update itself
+        CHECK(Value::live == 1);
+    }
+    CHECK(Value::live == 0);
+}
+
+void testUpdateWhileReading() {
+    APISnapshot<Value> snapshot;
+    {
+        auto reader = snapshot.read();
+        snapshot.update([](Value& value) { value.data = 1; });     // Does not wait for the reader
+        CHECK(reader->data == 0);           // The reader keeps its version
+        CHECK(snapshot.read()->data == 1);  // New readers see the update
+        CHECK(snapshot.reclaim() == 1);
+        CHECK(Value::live == 2);
+    }
+    CHECK(snapshot.reclaim() == 0);
+    CHECK(Value::live == 1);
+}
+
+void testNestedUpdates() {
+    APISnapshot<Value> snapshot;
+    {
+        auto outer = snapshot.read();
+        snapshot.update([](Value& value) { value.data = 1; });
+        auto inner = snapshot.read();
+        snapshot.update([](Value& value) { value.data = 2; });
+        CHECK(outer->data == 0);
+        CHECK(inner->data == 1);
+        CHECK(snapshot.reclaim() == 2);
+    }
+    CHECK(snapshot.reclaim() == 0);
+    CHECK(snapshot.read()->data == 2);
+    CHECK(Value::live == 1);
+}
+
+void testRetiredFreedOnDestruction() {
+    {
+        APISnapshot<Value> snapshot;
+        auto reader = std::make_unique<APISnapshot<Value>::Reader>(snapshot.read());
+        snapshot.update([](Value& value) { value.data = 1; });
+        reader.reset();
+        // Not reclaimed before the snapshot goes away
+    }
+    CHECK(Value::live == 0);
+}
+
+
+//##############################################################################
+//                             Concurrent readers
+//##############################################################################
+
+void testConcurrentReaders() {
+    {
+        APISnapshot<Value> snapshot;
+        std::atomic<bool> stop{false};
+        std::atomic<bool> torn{false};
+        std::vector<std::thread> readers;
+        for (int i = 0; i < 4; i++) {
+            readers.emplace_back([&]() {
+                while (!stop.load()) {
+                    auto reader = snapshot.read();
+                    int first = reader->data;
+                    std::this_thread::yield();
+                    if (reader->data != first) {
+                        torn = true;
+                    }
+                }
+            });
+        }
+        for (int i = 1; i <= 5000; i++) {
+            snapshot.update([i](Value& value) { value.data = i; });
+            if (i % 8 == 0) {
+                snapshot.reclaim();
+            }
+        }
+        stop = true;
+        for (auto& thread : readers) {
+            thread.join();
+        }
+        CHECK(!torn);
+        CHECK(snapshot.reclaim() == 0);
+        CHECK(snapshot.read()->data == 5000);
+        CHECK(Value::live == 1);
+    }
+    CHECK(Value::live == 0);
+}
+
+
+int main() {
+    RUN_TEST(testUpdateWithoutReaders);
+    RUN_TEST(testUpdateWhileReading);
+    RUN_TEST(testNestedUpdates);
+    RUN_TEST(testRetiredFreedOnDestruction);
+    RUN_TEST(testConcurrentReaders);
+    return testResult();
+}
@@ -0,0 +1,161 @@
+#include <vector>
+
+#include "APITest.h"
+#include <ArduinoJson.h>
+#include "../../lib/APIServer/src/APIServer.h"
+
+
+//##############################################################################
+//                             Helpers
+//##############################################################################
+
+// Validate a JSON request (nullptr = call without arguments)
+template <typename Params>
+bool validate(const Params& params, const char* json) {
+    APIValidationPlan plan;
+    plan.compile(params);
+    if (!json) {
+        return plan.validate(nullptr);
+    }
+    JsonDocument doc;
+    deserializeJson(doc, json);
+    JsonObject args = doc.as<JsonObject>();
+    return plan.validate(&args);
+}
+
+
+//##############################################################################
+//                             Presence and types
+//##############################################################################
+
+void testRequiredAndOptional() {
+    std::vector<APIParam> params = {
+        APIParam("ssid", APIParamType::String),
+        APIParam("channel", APIParamType::Integer, false),
+    };
+    CHECK(validate(params, "{\"ssid\":\"home\"}"));
+    CHECK(validate(params, "{\"ssid\":\"home\",\"channel\":6}"));
+    CHECK(!validate(params, "{\"channel\":6}"));        // Required missing
+    CHECK(!validate(params, "{\"ssid\":null}"));        // Null is absent
+    CHECK(!validate(params, nullptr));
+}
+
+void testNoArguments() {
+    std::vector<APIParam> none;
+    CHECK(validate(none, nullptr));
+    CHECK(validate(none, "{}"));
+
+    std::vector<APIParam> optional = {
+        APIParam("path", APIParamType::String, false),
+        APIParam("format", APIParamType::String, false),
+    };
+    CHECK(validate(optional, nullptr));     // Plain GET of a method with options only
+    CHECK(validate(optional, "{}"));
+    CHECK(validate(optional, "{\"format\":\"binary\"}"));
+    CHECK(!validate(optional, "{\"format\":1}"));
+}
+
+void testTypes() {
+    std::vector<APIParam> params = {
+        APIParam("on", APIParamType::Boolean),
+        APIParam("count", APIParamType::Integer),
+        APIParam("ratio", APIParamType::Number),
+        APIParam("name", APIParamType::String),
+    };
+    CHECK(validate(params, "{\"on\":true,\"count\":3,\"ratio\":0.5,\"name\":\"x\"}"));
+    CHECK(validate(params, "{\"on\":false,\"count\":3,\"ratio\":1,\"name\":\"\"}"));    // Integer is a number
+    CHECK(!validate(params, "{\"on\":1,\"count\":3,\"ratio\":0.5,\"name\":\"x\"}"));
+    CHECK(!validate(params, "{\"on\":true,\"count\":3.5,\"ratio\":0.5,\"name\":\"x\"}"));
+    CHECK(!validate(params, "{\"on\":true,\"count\":3,\"ratio\":\"0.5\",\"name\":\"x\"}"));
+    CHECK(!validate(params, "{\"on\":true,\"count\":3,\"ratio\":0.5,\"name\":5}"));
+}
+
+void testLimits() {
+    std::vector<APIParam> params = {
+        APIParam("clients", APIParamType::Integer, {0, 8}),
+        APIParam("ip", APIParamType::String, {7, 15}, false),
+    };
+    CHECK(validate(params, "{\"clients\":0}"));
+    CHECK(validate(params, "{\"clients\":8,\"ip\":\"10.0.0.1\"}"));
+    CHECK(!validate(params, "{\"clients\":9}"));
+    CHECK(!validate(params, "{\"clients\":-1}"));
+    CHECK(!validate(params, "{\"clients\":1,\"ip\":\"1.1.1\"}"));             // Too short
+    CHECK(!validate(params, "{\"clients\":1,\"ip\":\"255.255.255.2550\"}"));  // Too long
+}
+
+
+//##############################################################################
+//                             Nested objects
+//##############################################################################
+
+void testNestedObjects() {
+    std::vector<APIParam> params = {
+        APIParam("net", {
+            APIParam("ip", APIParamType::String),
+            APIParam("dns", {
+                APIParam("primary", APIParamType::String),
+            }, false),
+        }),
+        APIParam("name", APIParamType::String),
+    };
+    CHECK(validate(params, "{\"net\":{\"ip\":\"a\"},\"name\":\"n\"}"));
+    CHECK(validate(params, "{\"net\":{\"ip\":\"a\",\"dns\":{\"primary\":\"b\"}},\"name\":\"n\"}"));
+    CHECK(!validate(params, "{\"net\":{\"ip\":\"a\",\"dns\":{}},\"name\":\"n\"}"));   // Present: checked
+    CHECK(!validate(params, "{\"net\":{},\"name\":\"n\"}"));
+    CHECK(!validate(params, "{\"net\":\"a\",\"name\":\"n\"}"));
+    CHECK(!validate(params, "{\"net\":{\"ip\":\"a\"}}"));    // Sibling after the nested object
+}
+
+void testOptionalObjectSkipped() {
+    std::vector<APIParam> params = {
+        APIParam("options", {
+            APIParam("a", APIParamType::Integer),
+            APIParam("b", APIParamType::Integer),
+        }, false),
+        APIParam("id", APIParamType::Integer),
+    };
+    CHECK(validate(params, "{\"id\":1}"));      // Properties of the absent object skipped
+    CHECK(!validate(params, "{\"options\":{\"a\":1},\"id\":1}"));
+    CHECK(validate(params, "{\"options\":{\"a\":1,\"b\":2},\"id\":1}"));
+}
+
+void testDescriptors() {
+    static constexpr APIParamDescriptor DNS[] = {
+        {"primary", APIParamType::String},
+    };
+    static constexpr APIParamDescriptor PARAMS[] = {
+        {"channel", APIParamType::Integer, 1, 13},
+        {"dns", APIParamList(DNS), false},
+    };
+    APIParamList params(PARAMS);
+    CHECK(validate(params, "{\"channel\":6}"));
+    CHECK(validate(params, "{\"channel\":6,\"dns\":{\"primary\":\"b\"}}"));
+    CHECK(!validate(params, "{\"channel\":14}"));
+    CHECK(!validate(params, "{\"channel\":6,\"dns\":{}}"));
+}
+
+void testTooDeep() {
+    APIParam leaf("leaf", APIParamType::Integer);
+    APIParam level = leaf;
+    for (int i = 0; i <= APIValidationPlan::MAX_DEPTH; i++) {
+        level = APIParam("level", {level});
+    }
+    std::vector<APIParam> params = {level};
+    APIValidationPlan plan;
+    CHECK(!plan.compile(params));
+    CHECK(plan.size() == 0);
+}
+
+
+int main() {
+    Serial.muted = true;
+    RUN_TEST(testRequiredAndOptional);
+    RUN_TEST(testNoArguments);
+    RUN_TEST(testTypes);
+    RUN_TEST(testLimits);
+    RUN_TEST(testNestedObjects);
+    RUN_TEST(testOptionalObjectSkipped);
+    RUN_TEST(testDescriptors);
+    RUN_TEST(testTooDeep);
+    return testResult();
+}